@@ -1,7 +1,8 @@
 #include <benchmark/benchmark.h>  // google benchmark
-#include <umesimd/UMESimd.h>
 #include <algorithm>
+#include <cmath>
 #include <execution>
+#include <memory>
 #include <numeric>
 #include <iostream>
 #include <string>
@@ -10,6 +11,9 @@
 #include <array>
 #include "omp.h"
 #include "range/v3/view.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
+#include "pad/simd.hpp"
 
 
 using IndexType = ssize_t;
@@ -25,6 +29,58 @@ static void Args(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Args plus sizes that are not a multiple of simd_width, for the kernels
+// that handle a tail
+static void TailArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 15;
+  const auto upperLimit = 30;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+    b->Args({(1 << x) + 1});
+    b->Args({(1 << x) + 7});
+  }
+}
+
+// Sizes from L1- to DRAM-resident, each with the input starting 0..15 floats
+// past a cache line boundary
+static void OffsetArgs(benchmark::internal::Benchmark* b) {
+  for (auto x : {12, 16, 20, 24}) {
+    for (auto offset = 0; offset < 16; ++offset) {
+      b->Args({1 << x, offset});
+    }
+  }
+}
+
+// First element of c that sits on a cache line boundary
+static ValueType* lineAligned(ContainerType& c) {
+  void* p = c.data();
+  std::size_t space = c.size() * sizeof(ValueType);
+  return static_cast<ValueType*>(
+      std::align(pad::cache_line, sizeof(ValueType), p, space));
+}
+
+// DRAM-resident sizes with a prefetch distance in elements; 0 turns the
+// software prefetch off
+static void PrefetchArgs(benchmark::internal::Benchmark* b) {
+  for (auto x = 24; x <= 30; x += 2) {
+    for (auto distance : {0, 64, 128, 256, 512, 1024, 2048, 4096, 16384}) {
+      b->Args({1 << x, distance});
+    }
+  }
+}
+
+// Fine-grained sweep from L1-resident to DRAM-resident sizes
+static void CacheArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 10;
+  const auto upperLimit = 28;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+    b->Args({3 << (x - 1)});
+  }
+}
+
 void setCustomCounter(benchmark::State& state, std::string name ) {
 	state.counters["Elements"] = state.range(0);
 	state.counters["Bytes"] = state.range(0) * sizeof(ValueType);
@@ -108,73 +164,140 @@ static void benchReduceSimdStl(benchmark::State& state) {
 }
 
 // Ex 1.2.1
-static void benchReduceSimdUmeH(benchmark::State& state) {
+// The Simd* kernels are written once against pad::simd and instantiated for
+// every backend available in this build (see PAD_SIMD_BENCHMARKS below). The
+// work of every iteration goes through simd_isa, which builds it for the
+// ISA of the backend.
+template <typename Backend>
+static void benchReduceSimdH(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ValueType sum;
   for (auto _ : state) {
-    sum = 0;
-    UME::SIMD::SIMDVec<ValueType, simd_width> simd_vec;
-    for (auto x = X.begin(); x != X.end(); x += simd_width) {
-      simd_vec.load(&*x);
+    pad::simd_isa<SimdType>::run([&] {
+      sum = 0;
+      SimdType simd_vec;
+      for (auto x = X.begin(); x != X.end(); x += simd_width) {
+        simd_vec.load(&*x);
+        sum += simd_vec.hadd();
+      }
+    });
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("SimdH-") + Backend::name);
+}
+
+template <typename Backend>
+static void benchReduceSimdH2(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
+  ValueType sum;
+  const IndexType rest = X.size() % simd_width;
+  for (auto _ : state) {
+    pad::simd_isa<SimdType>::run([&] {
+      sum = 0;
+      SimdType simd_vec;
+      auto x = X.begin();
+      for (; x != X.end() - rest; x += simd_width) {
+        simd_vec.load(&*x);
+        sum += simd_vec.hadd();
+      }
+      // masked-out lanes are not loaded and read back as zero
+      simd_vec.masked_load(X.data() + (X.size() - rest), rest);
       sum += simd_vec.hadd();
-    }
+    });
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"UmeH");
+  setCustomCounter(state, std::string("SimdH2-") + Backend::name);
 }
 
-static void benchReduceSimdUmeH2(benchmark::State& state) {
+template <typename Backend>
+static void benchReduceSimdV(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ValueType sum;
   for (auto _ : state) {
-// TODO
-// like UmeH, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    pad::simd_isa<SimdType>::run([&] {
+      SimdType simd_sum = 0;
+      SimdType simd_vec;
+      for (auto x = X.begin(); x != X.end(); x += simd_width) {
+        simd_vec.load(&*x);
+        simd_sum += simd_vec;
+      }
+      sum = simd_sum.hadd();
+    });
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"UmeH2");
+  setCustomCounter(state, std::string("SimdV-") + Backend::name);
 }
 
-static void benchReduceSimdUmeV(benchmark::State& state) {
+template <typename Backend>
+static void benchReduceSimdV2(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ValueType sum;
-  UME::SIMD::SIMDVec<ValueType, simd_width> simd_sum;
+  const IndexType rest = X.size() % simd_width;
   for (auto _ : state) {
-    simd_sum = 0;
-    UME::SIMD::SIMDVec<ValueType, simd_width> simd_vec;
-    for (auto x = X.begin(); x != X.end(); x += simd_width) {
-      simd_vec.load(&*x);
+    pad::simd_isa<SimdType>::run([&] {
+      SimdType simd_sum = 0;
+      SimdType simd_vec;
+      auto x = X.begin();
+      for (; x != X.end() - rest; x += simd_width) {
+        simd_vec.load(&*x);
+        simd_sum += simd_vec;
+      }
+      simd_vec.masked_load(X.data() + (X.size() - rest), rest);
       simd_sum += simd_vec;
-    }
-	sum = simd_sum.hadd();
+      sum = simd_sum.hadd();
+    });
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"UmeV");
+  setCustomCounter(state, std::string("SimdV2-") + Backend::name);
 }
 
-static void benchReduceSimdUmeV2(benchmark::State& state) {
+// Unroll independent accumulators instead of one, so the adds of
+// consecutive vectors do not serialize on the FP-add latency
+template <typename Backend, int Unroll>
+static void benchReduceSimdVUnroll(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   constexpr IndexType simd_width = 8;
+  constexpr IndexType step = Unroll * simd_width;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ValueType sum;
-  UME::SIMD::SIMDVec<ValueType, simd_width> simd_sum;
   for (auto _ : state) {
-// TODO
-// like UmeV, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    pad::simd_isa<SimdType>::run([&] {
+      std::array<SimdType, Unroll> simd_sum;
+      for (auto& acc : simd_sum) acc = 0;
+      SimdType simd_vec;
+      for (auto x = X.begin(); x != X.end(); x += step) {
+        for (IndexType k = 0; k < Unroll; ++k) {
+          simd_vec.load(&*x + k * simd_width);
+          simd_sum[k] += simd_vec;
+        }
+      }
+      for (IndexType k = 1; k < Unroll; ++k) simd_sum[0] += simd_sum[k];
+      sum = simd_sum[0].hadd();
+    });
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"UmeV2");
+  state.counters["Unroll"] = Unroll;
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, std::string("SimdVUnroll") + std::to_string(Unroll) +
+                              "-" + Backend::name);
 }
 
 // Ex 1.2.2
@@ -195,52 +318,245 @@ static void benchReduceSimdOmpH(benchmark::State& state) {
 }
 
 static void benchReduceSimdOmpV(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  ValueType sum;
+  for (auto _ : state) {
+    // vertical simd_width accumulator, see pad::detail::reduce_vertical
+    sum = pad::reduce(pad::exec::simd, X.begin(), X.end());
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state,"OmpV");
+}
+
+static void benchReduceSimdOmpV2(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   constexpr IndexType simd_width = 8;
   ValueType sum;
   std::array<ValueType, simd_width> simd_sum;
+  const IndexType rest = X.size() % simd_width;
   for (auto _ : state) {
-    sum = 0;
     std::fill(simd_sum.begin(), simd_sum.end(), 0);
-    for (auto x = X.begin(); x != X.end(); x += simd_width) {
+    auto x = X.begin();
+    for (; x != X.end() - rest; x += simd_width) {
 #pragma omp simd
 	  for (IndexType i = 0; i < simd_width; ++i) {
         simd_sum[i] += *(x+i);
 	  }
     }
+#pragma omp simd
+    for (IndexType i = 0; i < rest; ++i) {
+      simd_sum[i] += *(x+i);
+    }
     sum = std::reduce(std::execution::unseq, simd_sum.begin(), simd_sum.end());
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"OmpV");
+  setCustomCounter(state,"OmpV2");
 }
 
-static void benchReduceSimdOmpV2(benchmark::State& state) {
+template <int Unroll>
+static void benchReduceSimdOmpVUnroll(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
-  constexpr IndexType simd_width = 8;
   ValueType sum;
-  std::array<ValueType, simd_width> simd_sum;
   for (auto _ : state) {
-// TODO
-// like OmpV, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    sum = pad::reduce(pad::exec::simd_unroll<Unroll>, X.begin(), X.end());
 	benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state,"OmpV2");
+  state.counters["Unroll"] = Unroll;
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, "OmpVUnroll" + std::to_string(Unroll));
+}
+
+// Kernel of the width x unroll x alignment grid that pad-tune picked for
+// this size on this host, or the plain simd path without a tuning file
+static void benchReduceTuned(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(pad::exec::tuned, X.begin(), X.end());
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, "Tuned");
+}
+
+// Per-block partial sums: K vectors accumulated vertically, then one
+// shuffle-tree reduction per block instead of one hadd per vector (UmeH)
+template <int K>
+static void benchReduceSimdHBlock(benchmark::State& state) {
+  constexpr IndexType block = K * pad::simd_width;
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  ContainerType partial((X.size() + block - 1) / block);
+  for (auto _ : state) {
+    pad::reduce_blocks<K>(pad::exec::simd, X.begin(), X.end(), partial.begin());
+	benchmark::DoNotOptimize(partial.data());
+    benchmark::ClobberMemory();
+  }
+  state.counters["Block"] = K;
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, "HBlock" + std::to_string(K));
+}
+
+static void benchReducePrefetch(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const auto policy = pad::exec::prefetch(pad::exec::simd, state.range(1));
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(policy, X.begin(), X.end());
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["Distance"] = state.range(1);
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, "Prefetch");
 }
 
-// TODO add the *2 versions to the benchmarking
-BENCHMARK(benchReduceIterator)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceRange)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceRangeFor)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceStl)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceSimdStl)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceSimdUmeH)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceSimdUmeV)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceSimdOmpH)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceSimdOmpV)->Apply(Args)->UseRealTime();
+// Split-line penalty: X starts state.range(1) floats past a cache line.
+// Aligned peels up to the next line first, so its main loop never splits.
+template <bool Aligned>
+static void benchReduceOffset(benchmark::State& state) {
+  ContainerType X(state.range(0) + 32);
+  ValueType* x = lineAligned(X) + state.range(1);
+  std::iota(x, x + state.range(0), ValueType{1});
+  ValueType sum;
+  for (auto _ : state) {
+    if constexpr (Aligned) {
+      sum = pad::reduce(pad::exec::simd_aligned, x, x + state.range(0));
+    } else {
+      sum = pad::reduce(pad::exec::simd, x, x + state.range(0));
+    }
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["Offset"] = state.range(1);
+  setCustomCounter(state, Aligned ? "AlignedOffset" : "Offset");
+}
+
+// Relative error of sum against the exact sum of [first, last), taken in
+// long double once outside the timed loop
+template <typename Iter>
+static double relativeError(Iter first, Iter last, ValueType sum) {
+  const long double exact = std::accumulate(first, last, 0.0L);
+  return exact == 0 ? 0.0 : static_cast<double>(std::abs((sum - exact) / exact));
+}
+
+// Compensated, pairwise and double-accumulated sums: the throughput each
+// accuracy mode costs against the plain simd kernel, and the error it buys
+template <pad::exec::summation Method>
+static void benchReduceAccurate(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const auto policy = pad::exec::accurate(pad::exec::simd, Method);
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(policy, X.begin(), X.end());
+	benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["RelError"] = relativeError(X.begin(), X.end(), sum);
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+  setCustomCounter(state, std::string("Accurate-") + pad::exec::name(Method));
+}
+
+BENCHMARK(benchReduceIterator)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceRange)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceRangeFor)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceStl)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceSimdStl)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceSimdOmpH)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceSimdOmpV)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceSimdOmpV2)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceTuned)->Apply(CacheArgs)->UseRealTime();
+
+// Unroll sweep over every cache level
+BENCHMARK_TEMPLATE(benchReduceSimdOmpVUnroll, 1)->Apply(CacheArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdOmpVUnroll, 2)->Apply(CacheArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdOmpVUnroll, 4)->Apply(CacheArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdOmpVUnroll, 8)->Apply(CacheArgs)->UseRealTime();
+
+// Block size sweep of the segmented horizontal reduction
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 1)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 2)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 4)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 8)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 16)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSimdHBlock, 32)->Apply(TailArgs)->UseRealTime();
+
+// Prefetch distance sweep
+BENCHMARK(benchReducePrefetch)->Apply(PrefetchArgs)->UseRealTime();
+
+// Pointer offset sweep, plain vs peeled
+BENCHMARK_TEMPLATE(benchReduceOffset, false)->Apply(OffsetArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceOffset, true)->Apply(OffsetArgs)->UseRealTime();
+
+// Accuracy modes
+BENCHMARK_TEMPLATE(benchReduceAccurate, pad::exec::summation::kahan)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceAccurate, pad::exec::summation::neumaier)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceAccurate, pad::exec::summation::pairwise)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceAccurate, pad::exec::summation::widened)->Apply(TailArgs)->UseRealTime();
+
+// One set of pad::simd kernels per backend, registered only if this CPU has
+// the ISA the backend's vectors need
+template <typename Backend>
+static bool registerSimdBenchmarks(const std::string& backend) {
+  using SimdType = pad::simd<ValueType, 8, Backend>;
+  if (!pad::simd_isa<SimdType>::supported()) return false;
+  auto name = [&](const std::string& bench) {
+    return bench + "<" + backend + ">";
+  };
+  auto unrolled = [&](int unroll) {
+    return "benchReduceSimdVUnroll<" + backend + ", " + std::to_string(unroll) +
+           ">";
+  };
+  benchmark::RegisterBenchmark(name("benchReduceSimdH").c_str(),
+                               benchReduceSimdH<Backend>)
+      ->Apply(Args)->UseRealTime();
+  benchmark::RegisterBenchmark(name("benchReduceSimdH2").c_str(),
+                               benchReduceSimdH2<Backend>)
+      ->Apply(TailArgs)->UseRealTime();
+  benchmark::RegisterBenchmark(name("benchReduceSimdV").c_str(),
+                               benchReduceSimdV<Backend>)
+      ->Apply(Args)->UseRealTime();
+  benchmark::RegisterBenchmark(name("benchReduceSimdV2").c_str(),
+                               benchReduceSimdV2<Backend>)
+      ->Apply(TailArgs)->UseRealTime();
+  benchmark::RegisterBenchmark(unrolled(1).c_str(),
+                               benchReduceSimdVUnroll<Backend, 1>)
+      ->Apply(CacheArgs)->UseRealTime();
+  benchmark::RegisterBenchmark(unrolled(2).c_str(),
+                               benchReduceSimdVUnroll<Backend, 2>)
+      ->Apply(CacheArgs)->UseRealTime();
+  benchmark::RegisterBenchmark(unrolled(4).c_str(),
+                               benchReduceSimdVUnroll<Backend, 4>)
+      ->Apply(CacheArgs)->UseRealTime();
+  benchmark::RegisterBenchmark(unrolled(8).c_str(),
+                               benchReduceSimdVUnroll<Backend, 8>)
+      ->Apply(CacheArgs)->UseRealTime();
+  return true;
+}
+
+#define PAD_SIMD_BENCHMARKS(Backend)                 \
+  static const bool BENCHMARK_PRIVATE_NAME(simd_) = \
+      registerSimdBenchmarks<Backend>(#Backend)
+
+PAD_SIMD_BENCHMARKS(pad::simd_backend::scalar);
+#if PAD_SIMD_HAVE_UME
+PAD_SIMD_BENCHMARKS(pad::simd_backend::ume);
+#endif
+#if PAD_SIMD_HAVE_STDX
+PAD_SIMD_BENCHMARKS(pad::simd_backend::stdx);
+#endif
+#if PAD_SIMD_HAVE_AVX2
+PAD_SIMD_BENCHMARKS(pad::simd_backend::avx);
+#endif
 
-BENCHMARK_MAIN();
+PAD_BENCHMARK_MAIN();
@@ -1,7 +1,7 @@
 #include <benchmark/benchmark.h>  // google benchmark
-#include <umesimd/UMESimd.h>
 #include <algorithm>
 #include <execution>
+#include <memory>
 #include <numeric>
 #include <iostream>
 #include <string>
@@ -9,6 +9,9 @@
 #include <vector>
 #include <array>
 #include "range/v3/view.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
+#include "pad/simd.hpp"
 
 
 
@@ -25,6 +28,47 @@ static void Args(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Args plus sizes that are not a multiple of simd_width, for the kernels
+// that handle a tail
+static void TailArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 15;
+  const auto upperLimit = 30;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+    b->Args({(1 << x) + 1});
+    b->Args({(1 << x) + 7});
+  }
+}
+
+// DRAM-resident sizes with a prefetch distance in elements; 0 turns the
+// software prefetch off
+static void PrefetchArgs(benchmark::internal::Benchmark* b) {
+  for (auto x = 24; x <= 30; x += 2) {
+    for (auto distance : {0, 64, 128, 256, 512, 1024, 2048, 4096, 16384}) {
+      b->Args({1 << x, distance});
+    }
+  }
+}
+
+// Sizes from L1- to DRAM-resident, each with the input starting 0..15 floats
+// past a cache line boundary
+static void OffsetArgs(benchmark::internal::Benchmark* b) {
+  for (auto x : {12, 16, 20, 24}) {
+    for (auto offset = 0; offset < 16; ++offset) {
+      b->Args({1 << x, offset});
+    }
+  }
+}
+
+// First element of c that sits on a cache line boundary
+static ValueType* lineAligned(ContainerType& c) {
+  void* p = c.data();
+  std::size_t space = c.size() * sizeof(ValueType);
+  return static_cast<ValueType*>(
+      std::align(pad::cache_line, sizeof(ValueType), p, space));
+}
+
 void setCustomCounter(benchmark::State& state, std::string name) {
   state.counters["Elements"] = state.range(0);
   state.counters["Bytes"] = 3 * state.range(0) * sizeof(ValueType);
@@ -70,14 +114,23 @@ static void benchTransformIteratorInnerLoop2(benchmark::State& state) {
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
 
+  const IndexType rest = X.size() % simd_width;
+
   for (auto _ : state) {
-// TODO
-// like IteratorInnerLoop, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    auto x = X.begin();
+    auto y = Y.begin();
+    for (; x != X.end() - rest; x += simd_width, y += simd_width) {
+      for (IndexType i = 0; i < simd_width; ++i) {
+        *(y + i) = a * (*(x + i)) + *(y + i);
+      }
+    }
+    for (IndexType i = 0; i < rest; ++i) {
+      *(y + i) = a * (*(x + i)) + *(y + i);
     }
     benchmark::ClobberMemory();
-    setCustomCounter(state, "IteratorInnerLoop2");
   }
+  setCustomCounter(state, "IteratorInnerLoop2");
+}
 static void benchTransformRange(benchmark::State& state) {
   ValueType a = -1;
   ContainerType X(state.range(0), 1);
@@ -114,14 +167,23 @@ static void benchTransformRangeInnerLoop2(benchmark::State& state) {
   ValueType a = -1;
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
+  const IndexType body = state.range(0) / simd_width;
+  const IndexType rest = state.range(0) % simd_width;
   for (auto _ : state) {
-// TODO
-// like RangeInnerLoop, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    for (auto u : ranges::iota_view<IndexType, IndexType>(0, body)) {
+	  auto U = u * simd_width;
+      for (IndexType i = 0; i < simd_width; ++i) {
+        Y[U + i] = a * X[U + i] + Y[U + i];
+      }
+    }
+    const IndexType U = body * simd_width;
+    for (IndexType i = 0; i < rest; ++i) {
+      Y[U + i] = a * X[U + i] + Y[U + i];
     }
     benchmark::ClobberMemory();
-    setCustomCounter(state, "RangeInnerLoop2");
   }
+  setCustomCounter(state, "RangeInnerLoop2");
+}
 
 // Ex 1.1.2
 static void benchTransformStl(benchmark::State& state) {
@@ -152,39 +214,65 @@ static void benchTransformSimdStl(benchmark::State& state) {
   setCustomCounter(state, "SimdStl");
 }
 
-static void benchUmeSimdTransform(benchmark::State& state) {
+// Same kernel for every pad::simd backend, built through simd_isa for the
+// ISA of the backend
+template <typename Backend>
+static void benchSimdTransform(benchmark::State& state) {
   constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
 
   for (auto _ : state) {
-    UME::SIMD::SIMDVec<ValueType, simd_width> a_vec(-1);
-    UME::SIMD::SIMDVec<ValueType, simd_width> x_vec, y_vec;
-    for (auto x = X.begin(), y = Y.begin(); x != X.end();
-         x += simd_width, y += simd_width) {
-      x_vec.load(&*x);
-      y_vec.load(&*y);
-      y_vec = a_vec * x_vec + y_vec;
-      y_vec.store(&*y);
-    }
+    pad::simd_isa<SimdType>::run([&] {
+      SimdType a_vec(-1);
+      SimdType x_vec, y_vec;
+      for (auto x = X.begin(), y = Y.begin(); x != X.end();
+           x += simd_width, y += simd_width) {
+        x_vec.load(&*x);
+        y_vec.load(&*y);
+        y_vec = fma(a_vec, x_vec, y_vec);
+        y_vec.store(&*y);
+      }
+    });
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "Ume");
+  setCustomCounter(state, std::string("Simd-") + Backend::name);
 }
 
-static void benchUmeSimdTransform2(benchmark::State& state) {
+template <typename Backend>
+static void benchSimdTransform2(benchmark::State& state) {
   constexpr IndexType simd_width = 8;
+  using SimdType = pad::simd<ValueType, simd_width, Backend>;
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
 
+  const IndexType rest = X.size() % simd_width;
+
   for (auto _ : state) {
-// TODO
-// like benchUmeSimdTransform, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
-    }
+    pad::simd_isa<SimdType>::run([&] {
+      SimdType a_vec(-1);
+      SimdType x_vec, y_vec;
+      auto x = X.begin();
+      auto y = Y.begin();
+      for (; x != X.end() - rest; x += simd_width, y += simd_width) {
+        x_vec.load(&*x);
+        y_vec.load(&*y);
+        y_vec = fma(a_vec, x_vec, y_vec);
+        y_vec.store(&*y);
+      }
+      // masked epilogue: lanes beyond rest are neither read nor written
+      ValueType* x_tail = X.data() + (X.size() - rest);
+      ValueType* y_tail = Y.data() + (Y.size() - rest);
+      x_vec.masked_load(x_tail, rest);
+      y_vec.masked_load(y_tail, rest);
+      y_vec = fma(a_vec, x_vec, y_vec);
+      y_vec.masked_store(y_tail, rest);
+    });
     benchmark::ClobberMemory();
-    setCustomCounter(state, "Ume2");
   }
+  setCustomCounter(state, std::string("Simd2-") + Backend::name);
+}
 
 // Ex 1.2.2
 static void benchOmpSimdTransformIterator(benchmark::State& state) {
@@ -193,12 +281,7 @@ static void benchOmpSimdTransformIterator(benchmark::State& state) {
   ContainerType Y(state.range(0), 2);
 
   for (auto _ : state) {
-    auto y = Y.begin();
-#pragma omp simd
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(pad::exec::simd, a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "OmpIterator");
@@ -263,26 +346,130 @@ static void benchOmpSimdTransformRangeInnerLoop2(benchmark::State& state) {
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
 
+  const int64_t body = state.range(0) / simd_width;
+  const IndexType rest = state.range(0) % simd_width;
+
   for (auto _ : state) {
-// TODO
-// like OmpRangeInnerLoop, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+    for (auto u : ranges::iota_view<int64_t, int64_t>(0, body)) {
+      auto U = u * simd_width;
+#pragma omp simd
+      for (IndexType i = 0; i < simd_width; ++i) {
+        Y[U + i] = a * X[U + i] + Y[U + i];
+      }
+    }
+    const IndexType U = body * simd_width;
+#pragma omp simd
+    for (IndexType i = 0; i < rest; ++i) {
+      Y[U + i] = a * X[U + i] + Y[U + i];
+    }
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "OmpRangeInnerLoop2");
 }
 
 
-// TODO add the *2 versions to the benchmarking
-BENCHMARK(benchTransformIterator)->Apply(Args)->UseRealTime();
+// Kernel of the width x unroll x alignment grid that pad-tune picked for
+// this size on this host, or the plain simd path without a tuning file
+static void benchTransformTuned(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+
+  for (auto _ : state) {
+    pad::transform(pad::exec::tuned, a, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "Tuned");
+}
+
+static void benchTransformPrefetch(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const auto policy = pad::exec::prefetch(pad::exec::simd, state.range(1));
+
+  for (auto _ : state) {
+    pad::transform(policy, a, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  state.counters["Distance"] = state.range(1);
+  state.SetBytesProcessed(state.iterations() * 3 * state.range(0) *
+                          sizeof(ValueType));
+  setCustomCounter(state, "Prefetch");
+}
+
+// Split-line penalty: X and Y start state.range(1) floats past a cache line.
+// Aligned peels up to the next line first, so its main loop never splits.
+template <bool Aligned>
+static void benchTransformOffset(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0) + 32, 1);
+  ContainerType Y(state.range(0) + 32, 2);
+  ValueType* x = lineAligned(X) + state.range(1);
+  ValueType* y = lineAligned(Y) + state.range(1);
+
+  for (auto _ : state) {
+    if constexpr (Aligned) {
+      pad::transform(pad::exec::simd_aligned, a, x, x + state.range(0), y);
+    } else {
+      pad::transform(pad::exec::simd, a, x, x + state.range(0), y);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.counters["Offset"] = state.range(1);
+  setCustomCounter(state, Aligned ? "AlignedOffset" : "Offset");
+}
+
+BENCHMARK(benchTransformIterator)->Apply(TailArgs)->UseRealTime();
 BENCHMARK(benchTransformIteratorInnerLoop)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformRange)->Apply(Args)->UseRealTime();
+BENCHMARK(benchTransformIteratorInnerLoop2)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformRange)->Apply(TailArgs)->UseRealTime();
 BENCHMARK(benchTransformRangeInnerLoop)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformStl)->Apply(Args)->UseRealTime();
-BENCHMARK(benchOmpSimdTransformIterator)->Apply(Args)->UseRealTime();
+BENCHMARK(benchTransformRangeInnerLoop2)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformStl)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchOmpSimdTransformIterator)->Apply(TailArgs)->UseRealTime();
 BENCHMARK(benchOmpSimdTransformIteratorInnerLoop)->Apply(Args)->UseRealTime();
-BENCHMARK(benchOmpSimdTransformRange)->Apply(Args)->UseRealTime();
+BENCHMARK(benchOmpSimdTransformRange)->Apply(TailArgs)->UseRealTime();
 BENCHMARK(benchOmpSimdTransformRangeInnerLoop)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformSimdStl)->Apply(Args)->UseRealTime();
-BENCHMARK(benchUmeSimdTransform)->Apply(Args)->UseRealTime();
-BENCHMARK_MAIN();
+BENCHMARK(benchOmpSimdTransformRangeInnerLoop2)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformSimdStl)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformTuned)->Apply(TailArgs)->UseRealTime();
+
+// Prefetch distance sweep
+BENCHMARK(benchTransformPrefetch)->Apply(PrefetchArgs)->UseRealTime();
+
+// Pointer offset sweep, plain vs peeled
+BENCHMARK_TEMPLATE(benchTransformOffset, false)->Apply(OffsetArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformOffset, true)->Apply(OffsetArgs)->UseRealTime();
+
+// One set of pad::simd kernels per backend, registered only if this CPU has
+// the ISA the backend's vectors need
+template <typename Backend>
+static bool registerSimdBenchmarks(const std::string& backend) {
+  using SimdType = pad::simd<ValueType, 8, Backend>;
+  if (!pad::simd_isa<SimdType>::supported()) return false;
+  benchmark::RegisterBenchmark(("benchSimdTransform<" + backend + ">").c_str(),
+                               benchSimdTransform<Backend>)
+      ->Apply(Args)->UseRealTime();
+  benchmark::RegisterBenchmark(("benchSimdTransform2<" + backend + ">").c_str(),
+                               benchSimdTransform2<Backend>)
+      ->Apply(TailArgs)->UseRealTime();
+  return true;
+}
+
+#define PAD_SIMD_BENCHMARKS(Backend)                 \
+  static const bool BENCHMARK_PRIVATE_NAME(simd_) = \
+      registerSimdBenchmarks<Backend>(#Backend)
+
+PAD_SIMD_BENCHMARKS(pad::simd_backend::scalar);
+#if PAD_SIMD_HAVE_UME
+PAD_SIMD_BENCHMARKS(pad::simd_backend::ume);
+#endif
+#if PAD_SIMD_HAVE_STDX
+PAD_SIMD_BENCHMARKS(pad::simd_backend::stdx);
+#endif
+#if PAD_SIMD_HAVE_AVX2
+PAD_SIMD_BENCHMARKS(pad::simd_backend::avx);
+#endif
+
+PAD_BENCHMARK_MAIN();
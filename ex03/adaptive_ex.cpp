@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>  // google benchmark
+#include <numeric>
+#include <string>
+#include <vector>
+#include "pad/bench.hpp"
+#include "pad/dispatch.hpp"
+#include "pad/kernels.hpp"
+
+using ValueType = float;
+using ContainerType = std::vector<ValueType>;
+
+// From far below to far above the size where the parallel paths pay off
+static void AdaptiveArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 10;
+  const auto upperLimit = 30;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+  }
+}
+
+void setCustomCounter(benchmark::State& state, std::string name) {
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = state.range(0) * sizeof(ValueType);
+  state.SetLabel(name);
+}
+
+// Path exec::adaptive takes for this size, as counters next to its time
+void setDecisionCounter(benchmark::State& state, pad::dispatch::kernel k) {
+  const auto d = pad::dispatch::choose(k, state.range(0));
+  state.counters["Backend"] = static_cast<int>(d.path);
+  state.counters["Threads"] = d.threads;
+  setCustomCounter(state,
+                   std::string("Adaptive/") + pad::dispatch::name(d.path));
+}
+
+const char* policyName(pad::exec::simd_policy) { return "Serial"; }
+const char* policyName(pad::exec::omp_policy) { return "Omp"; }
+const char* policyName(pad::exec::tbb_policy) { return "Tbb"; }
+const char* policyName(pad::exec::numa_policy) { return "Numa"; }
+
+template <typename Policy>
+static void benchReduceBackend(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(Policy{}, X.begin(), X.end());
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, policyName(Policy{}));
+}
+
+static void benchReduceAdaptive(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  // calibrate outside of the timed loop
+  pad::dispatch::calibrated();
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(pad::exec::adaptive, X.begin(), X.end());
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setDecisionCounter(state, pad::dispatch::kernel::reduce);
+}
+
+template <typename Policy>
+static void benchTransformBackend(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  for (auto _ : state) {
+    pad::transform(Policy{}, -1, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, policyName(Policy{}));
+}
+
+static void benchTransformAdaptive(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  pad::dispatch::calibrated();
+  for (auto _ : state) {
+    pad::transform(pad::exec::adaptive, -1, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  setDecisionCounter(state, pad::dispatch::kernel::transform);
+}
+
+BENCHMARK_TEMPLATE(benchReduceBackend, pad::exec::simd_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceBackend, pad::exec::omp_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceBackend, pad::exec::tbb_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceBackend, pad::exec::numa_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK(benchReduceAdaptive)->Apply(AdaptiveArgs)->UseRealTime();
+
+BENCHMARK_TEMPLATE(benchTransformBackend, pad::exec::simd_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformBackend, pad::exec::omp_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformBackend, pad::exec::tbb_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformBackend, pad::exec::numa_policy)
+    ->Apply(AdaptiveArgs)
+    ->UseRealTime();
+BENCHMARK(benchTransformAdaptive)->Apply(AdaptiveArgs)->UseRealTime();
+PAD_BENCHMARK_MAIN();
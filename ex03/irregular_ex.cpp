@@ -0,0 +1,431 @@
+#include <benchmark/benchmark.h>  // google benchmark
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "omp.h"
+#include "oneapi/tbb.h"
+#include "pad/bench.hpp"
+
+// Partitioners and OpenMP schedules under load imbalance: every element
+// costs a number of dependent multiply-adds given by a generated profile.
+// Next to the time, the counters report how evenly the work units ended up
+// on the threads (Imbalance = busiest thread / mean over all threads, 1 is
+// perfect) and how many chunks the scheduler handed out. The timed loop only
+// logs the chunks each thread ran; their cost is summed between iterations
+// with the timer paused.
+
+using IndexType = ssize_t;
+using ValueType = float;
+using ContainerType = std::vector<ValueType>;
+using CostType = int;
+using CostContainer = std::vector<CostType>;
+
+static constexpr IndexType Elements = 1 << 16;
+static constexpr CostType MaxCost = 256;
+
+enum class Profile { Ramp, HeavyTail, Hotspots, Mandelbrot };
+
+const char* profileName(Profile p) {
+  switch (p) {
+    case Profile::Ramp:
+      return "Ramp";
+    case Profile::HeavyTail:
+      return "HeavyTail";
+    case Profile::Hotspots:
+      return "Hotspots";
+    default:
+      return "Mandelbrot";
+  }
+}
+
+// Cost of every element in [1, MaxCost]; the same for every run.
+CostContainer makeProfile(Profile p, IndexType n) {
+  CostContainer cost(n, 1);
+  switch (p) {
+    case Profile::Ramp:
+      // linear from 1 at the front to MaxCost at the back
+      for (IndexType i = 0; i < n; ++i) {
+        cost[i] = 1 + static_cast<CostType>((MaxCost - 1) * i / n);
+      }
+      break;
+    case Profile::HeavyTail: {
+      // Pareto with shape 1.5: mostly cheap, a few elements very expensive
+      std::mt19937 gen(42);
+      std::uniform_real_distribution<double> u(0.0, 1.0);
+      for (auto& c : cost) {
+        const double pareto = std::pow(1.0 - u(gen), -1.0 / 1.5);
+        c = static_cast<CostType>(std::min<double>(pareto, MaxCost));
+      }
+      break;
+    }
+    case Profile::Hotspots: {
+      // eight clusters of 1/64 of the range at MaxCost, at random places
+      std::mt19937 gen(7);
+      const IndexType width = std::max<IndexType>(n / 64, 1);
+      std::uniform_int_distribution<IndexType> start(0, n - width);
+      for (int h = 0; h < 8; ++h) {
+        const IndexType s = start(gen);
+        std::fill(cost.begin() + s, cost.begin() + s + width, MaxCost);
+      }
+      break;
+    }
+    case Profile::Mandelbrot: {
+      // escape time of the pixels of a square image in row-major order
+      const IndexType side = std::max<IndexType>(std::sqrt(double(n)), 1);
+      for (IndexType i = 0; i < n; ++i) {
+        const std::complex<double> c(-2.0 + 3.0 * (i % side) / side,
+                                     -1.5 + 3.0 * (i / side % side) / side);
+        std::complex<double> z = 0;
+        CostType k = 1;
+        while (k < MaxCost && std::norm(z) <= 4.0) {
+          z = z * z + c;
+          ++k;
+        }
+        cost[i] = k;
+      }
+      break;
+    }
+  }
+  return cost;
+}
+
+// `cost` dependent multiply-adds starting from x
+inline ValueType work(ValueType x, CostType cost) {
+  for (CostType k = 0; k < cost; ++k) {
+    x = x * ValueType{0.999} + ValueType{0.001};
+  }
+  return x;
+}
+
+// Work units and chunks done by one thread, a cache line per thread
+struct alignas(64) ThreadLoad {
+  long work = 0;
+  long chunks = 0;
+};
+
+// One chunk [begin, end) a thread ran
+struct Chunk {
+  IndexType begin;
+  IndexType end;
+};
+
+// Chunks of one thread in the current iteration, a cache line per thread.
+// Reserved for the whole range, so logging a chunk never allocates.
+struct alignas(64) ThreadLog {
+  std::vector<Chunk> chunks;
+};
+
+using ChunkLog = std::vector<ThreadLog>;
+
+ChunkLog makeChunkLog(int threads, IndexType n) {
+  ChunkLog log(threads);
+  for (auto& l : log) l.chunks.reserve(n);
+  return log;
+}
+
+// Adds the cost and number of the logged chunks to the load of their thread
+// and empties the log; call it outside the timed region
+void drainChunkLog(ChunkLog& log, const CostType* cost,
+                   std::vector<ThreadLoad>& load) {
+  for (std::size_t t = 0; t < log.size(); ++t) {
+    for (const Chunk& c : log[t].chunks) {
+      load[t].work += std::accumulate(cost + c.begin, cost + c.end, 0L);
+    }
+    load[t].chunks += log[t].chunks.size();
+    log[t].chunks.clear();
+  }
+}
+
+void setLoadCounters(benchmark::State& state,
+                     const std::vector<ThreadLoad>& load) {
+  long total = 0, busiest = 0, chunks = 0;
+  for (const auto& l : load) {
+    total += l.work;
+    busiest = std::max(busiest, l.work);
+    chunks += l.chunks;
+  }
+  const double mean = double(total) / load.size();
+  state.counters["Imbalance"] = mean > 0 ? busiest / mean : 1.0;
+  state.counters["Threads"] = load.size();
+  state.counters["Chunks"] =
+      double(chunks) / std::max<long>(state.iterations(), 1);
+}
+
+// Problem size times grain or chunk size in elements
+static void IrregularArgs(benchmark::internal::Benchmark* b) {
+  for (auto y = 0; y <= 12; y += 2) {
+    b->Args({Elements, 1 << y});
+  }
+}
+
+void setCustomCounter(benchmark::State& state, std::string name) {
+  state.counters["Elements"] = state.range(0);
+  state.counters["GrainSize"] = state.range(1);
+  state.SetLabel(name);
+}
+
+template <typename Partitioner>
+const char* partitionerName();
+template <>
+const char* partitionerName<oneapi::tbb::auto_partitioner>() {
+  return "TbbAutoPartitioner";
+}
+template <>
+const char* partitionerName<oneapi::tbb::simple_partitioner>() {
+  return "TbbSimplePartitioner";
+}
+template <>
+const char* partitionerName<oneapi::tbb::static_partitioner>() {
+  return "TbbStaticPartitioner";
+}
+template <>
+const char* partitionerName<oneapi::tbb::affinity_partitioner>() {
+  return "TbbAffinityPartitioner";
+}
+
+enum class Schedule { Static, Dynamic, Guided, NonmonotonicDynamic };
+
+const char* scheduleName(Schedule s) {
+  switch (s) {
+    case Schedule::Static:
+      return "ScheduleStatic";
+    case Schedule::Dynamic:
+      return "ScheduleDynamic";
+    case Schedule::Guided:
+      return "ScheduleGuided";
+    default:
+      return "ScheduleNonmonotonicDynamic";
+  }
+}
+
+template <Profile P, typename Partitioner>
+static void benchReduceIrregularTbb(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  ContainerType X(state.range(0), 1);
+  const CostContainer C = makeProfile(P, state.range(0));
+  const ValueType* x = X.data();
+  const CostType* cost = C.data();
+  const int threads = this_task_arena::max_concurrency();
+  std::vector<ThreadLoad> load(threads);
+  ChunkLog log = makeChunkLog(threads, state.range(0));
+  Partitioner part;
+  for (auto _ : state) {
+    ValueType sum = parallel_reduce(
+        blocked_range<IndexType>(0, state.range(0), state.range(1)),
+        ValueType{0},
+        [&](const blocked_range<IndexType>& r, ValueType acc) {
+          for (IndexType i = r.begin(); i < r.end(); ++i) {
+            acc += work(x[i], cost[i]);
+          }
+          log[this_task_arena::current_thread_index()].chunks.push_back(
+              {r.begin(), r.end()});
+          return acc;
+        },
+        std::plus<ValueType>(), part);
+    benchmark::DoNotOptimize(&sum);
+    state.PauseTiming();
+    drainChunkLog(log, cost, load);
+    state.ResumeTiming();
+  }
+  setLoadCounters(state, load);
+  setCustomCounter(state, std::string(profileName(P)) + "/" +
+                              partitionerName<Partitioner>());
+}
+
+template <Profile P, typename Partitioner>
+static void benchTransformIrregularTbb(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const CostContainer C = makeProfile(P, state.range(0));
+  const ValueType* x = X.data();
+  ValueType* y = Y.data();
+  const CostType* cost = C.data();
+  const int threads = this_task_arena::max_concurrency();
+  std::vector<ThreadLoad> load(threads);
+  ChunkLog log = makeChunkLog(threads, state.range(0));
+  Partitioner part;
+  for (auto _ : state) {
+    parallel_for(
+        blocked_range<IndexType>(0, state.range(0), state.range(1)),
+        [&](const blocked_range<IndexType>& r) {
+          for (IndexType i = r.begin(); i < r.end(); ++i) {
+            y[i] = work(x[i], cost[i]) + y[i];
+          }
+          log[this_task_arena::current_thread_index()].chunks.push_back(
+              {r.begin(), r.end()});
+        },
+        part);
+    benchmark::ClobberMemory();
+    state.PauseTiming();
+    drainChunkLog(log, cost, load);
+    state.ResumeTiming();
+  }
+  setLoadCounters(state, load);
+  setCustomCounter(state, std::string(profileName(P)) + "/" +
+                              partitionerName<Partitioner>());
+}
+
+// Runs body(thread, i) for i in [0, n) under schedule(S, chunk) and logs
+// the chunks of every thread. A thread starts a new chunk whenever its next
+// index does not follow the previous one; the chunk's end is filled in when
+// the next one starts or the loop ends.
+template <Schedule S, typename Body>
+void forSchedule(IndexType n, int chunk, ChunkLog& log, Body body) {
+#pragma omp parallel
+  {
+    const int thread = omp_get_thread_num();
+    std::vector<Chunk>& mine = log[thread].chunks;
+    IndexType next = -1;
+    auto step = [&](IndexType i) {
+      if (i != next) {
+        if (!mine.empty()) mine.back().end = next;
+        mine.push_back({i, i});
+      }
+      body(thread, i);
+      next = i + 1;
+    };
+    if constexpr (S == Schedule::Static) {
+#pragma omp for schedule(static, chunk)
+      for (IndexType i = 0; i < n; ++i) step(i);
+    } else if constexpr (S == Schedule::Dynamic) {
+#pragma omp for schedule(dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) step(i);
+    } else if constexpr (S == Schedule::Guided) {
+#pragma omp for schedule(guided, chunk)
+      for (IndexType i = 0; i < n; ++i) step(i);
+    } else {
+#pragma omp for schedule(nonmonotonic : dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) step(i);
+    }
+    if (!mine.empty()) mine.back().end = next;
+  }
+}
+
+// Partial sum of one thread, a cache line per thread
+struct alignas(64) PartialSum {
+  ValueType sum = 0;
+};
+
+template <Profile P, Schedule S>
+static void benchReduceIrregularOmp(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  const CostContainer C = makeProfile(P, state.range(0));
+  const ValueType* x = X.data();
+  const CostType* cost = C.data();
+  std::vector<ThreadLoad> load(omp_get_max_threads());
+  ChunkLog log = makeChunkLog(omp_get_max_threads(), state.range(0));
+  std::vector<PartialSum> partial(omp_get_max_threads());
+  for (auto _ : state) {
+    for (auto& p : partial) p.sum = 0;
+    forSchedule<S>(state.range(0), state.range(1), log,
+                   [&](int thread, IndexType i) {
+                     partial[thread].sum += work(x[i], cost[i]);
+                   });
+    ValueType sum = 0;
+    for (const auto& p : partial) sum += p.sum;
+    benchmark::DoNotOptimize(&sum);
+    state.PauseTiming();
+    drainChunkLog(log, cost, load);
+    state.ResumeTiming();
+  }
+  setLoadCounters(state, load);
+  setCustomCounter(state,
+                   std::string(profileName(P)) + "/" + scheduleName(S));
+}
+
+template <Profile P, Schedule S>
+static void benchTransformIrregularOmp(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const CostContainer C = makeProfile(P, state.range(0));
+  const ValueType* x = X.data();
+  ValueType* y = Y.data();
+  const CostType* cost = C.data();
+  std::vector<ThreadLoad> load(omp_get_max_threads());
+  ChunkLog log = makeChunkLog(omp_get_max_threads(), state.range(0));
+  for (auto _ : state) {
+    forSchedule<S>(state.range(0), state.range(1), log,
+                   [&](int, IndexType i) {
+                     y[i] = work(x[i], cost[i]) + y[i];
+                   });
+    benchmark::ClobberMemory();
+    state.PauseTiming();
+    drainChunkLog(log, cost, load);
+    state.ResumeTiming();
+  }
+  setLoadCounters(state, load);
+  setCustomCounter(state,
+                   std::string(profileName(P)) + "/" + scheduleName(S));
+}
+
+// Every partitioner and schedule for one profile
+#define PAD_IRREGULAR_BENCHMARKS(P)                                          \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularTbb, P,                            \
+                      oneapi::tbb::auto_partitioner)                         \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularTbb, P,                            \
+                      oneapi::tbb::simple_partitioner)                       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularTbb, P,                            \
+                      oneapi::tbb::static_partitioner)                       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularTbb, P,                            \
+                      oneapi::tbb::affinity_partitioner)                     \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularTbb, P,                         \
+                      oneapi::tbb::auto_partitioner)                         \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularTbb, P,                         \
+                      oneapi::tbb::simple_partitioner)                       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularTbb, P,                         \
+                      oneapi::tbb::static_partitioner)                       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularTbb, P,                         \
+                      oneapi::tbb::affinity_partitioner)                     \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularOmp, P, Schedule::Static)          \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularOmp, P, Schedule::Dynamic)         \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularOmp, P, Schedule::Guided)          \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceIrregularOmp, P,                            \
+                      Schedule::NonmonotonicDynamic)                         \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularOmp, P, Schedule::Static)       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularOmp, P, Schedule::Dynamic)      \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularOmp, P, Schedule::Guided)       \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchTransformIrregularOmp, P,                         \
+                      Schedule::NonmonotonicDynamic)                         \
+      ->Apply(IrregularArgs)                                                 \
+      ->UseRealTime()
+
+PAD_IRREGULAR_BENCHMARKS(Profile::Ramp);
+PAD_IRREGULAR_BENCHMARKS(Profile::HeavyTail);
+PAD_IRREGULAR_BENCHMARKS(Profile::Hotspots);
+PAD_IRREGULAR_BENCHMARKS(Profile::Mandelbrot);
+PAD_BENCHMARK_MAIN();
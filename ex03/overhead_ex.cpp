@@ -0,0 +1,319 @@
+#include <benchmark/benchmark.h>  // google benchmark
+#include <algorithm>
+#include <chrono>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "omp.h"
+#include "oneapi/tbb.h"
+#include "pad/bench.hpp"
+#include "pad/numa.hpp"
+
+// Bare cost of one fork-join of every parallel construct used in ex03 and
+// ex05. Each call touches only `Elements` floats, so the time is the
+// overhead. Every call is timed on its own; besides the mean, the counters
+// hold the median, the 90th and 99th percentile and the worst call.
+
+using IndexType = ssize_t;
+using ValueType = float;
+using ContainerType = std::vector<ValueType>;
+
+// One element per loop iteration; enough that every thread gets some
+static constexpr IndexType Elements = 1 << 10;
+
+// 1, 2, 4, ... threads and the default team size
+static void ThreadArgs(benchmark::internal::Benchmark* b) {
+  const int maxThreads = omp_get_max_threads();
+  for (int t = 1; t < maxThreads; t *= 2) {
+    b->Args({t});
+  }
+  b->Args({maxThreads});
+}
+
+void setCustomCounter(benchmark::State& state, std::string name) {
+  state.counters["Threads"] = state.range(0);
+  state.counters["Elements"] = Elements;
+  state.SetLabel(name);
+}
+
+// Runs f once per iteration with manual timing and sets the latency
+// percentiles of the calls, in ns.
+template <typename F>
+void timeCalls(benchmark::State& state, F&& f) {
+  using clock = std::chrono::steady_clock;
+  std::vector<double> samples;
+  for (auto _ : state) {
+    const auto start = clock::now();
+    f();
+    const double t =
+        std::chrono::duration<double>(clock::now() - start).count();
+    state.SetIterationTime(t);
+    samples.push_back(t);
+  }
+  if (samples.empty()) return;
+  std::sort(samples.begin(), samples.end());
+  auto at = [&](double q) {
+    return samples[static_cast<std::size_t>(q * (samples.size() - 1))] * 1e9;
+  };
+  state.counters["p50_ns"] = at(0.5);
+  state.counters["p90_ns"] = at(0.9);
+  state.counters["p99_ns"] = at(0.99);
+  state.counters["max_ns"] = samples.back() * 1e9;
+}
+
+static void benchOverheadOmpParallel(benchmark::State& state) {
+  const int threads = state.range(0);
+  timeCalls(state, [&] {
+#pragma omp parallel num_threads(threads)
+    {
+      benchmark::ClobberMemory();
+    }
+  });
+  setCustomCounter(state, "OmpParallel");
+}
+
+enum class Schedule { Static, Dynamic, Guided, Auto };
+
+template <Schedule S>
+static void benchOverheadOmpFor(benchmark::State& state) {
+  const int threads = state.range(0);
+  ContainerType X(Elements, 1);
+  ValueType* x = X.data();
+  timeCalls(state, [&] {
+    if constexpr (S == Schedule::Static) {
+#pragma omp parallel for num_threads(threads) schedule(static)
+      for (IndexType i = 0; i < Elements; ++i) x[i] += 1;
+    } else if constexpr (S == Schedule::Dynamic) {
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+      for (IndexType i = 0; i < Elements; ++i) x[i] += 1;
+    } else if constexpr (S == Schedule::Guided) {
+#pragma omp parallel for num_threads(threads) schedule(guided)
+      for (IndexType i = 0; i < Elements; ++i) x[i] += 1;
+    } else {
+#pragma omp parallel for num_threads(threads) schedule(auto)
+      for (IndexType i = 0; i < Elements; ++i) x[i] += 1;
+    }
+    benchmark::ClobberMemory();
+  });
+  const char* names[] = {"OmpForStatic", "OmpForDynamic", "OmpForGuided",
+                         "OmpForAuto"};
+  setCustomCounter(state, names[static_cast<int>(S)]);
+}
+
+static void benchOverheadOmpTaskloop(benchmark::State& state) {
+  const int threads = state.range(0);
+  ContainerType X(Elements, 1);
+  ValueType* x = X.data();
+  timeCalls(state, [&] {
+#pragma omp parallel num_threads(threads)
+#pragma omp single
+#pragma omp taskloop
+    for (IndexType i = 0; i < Elements; ++i) x[i] += 1;
+    benchmark::ClobberMemory();
+  });
+  setCustomCounter(state, "OmpTaskloop");
+}
+
+template <typename Partitioner>
+const char* partitionerName();
+template <>
+const char* partitionerName<oneapi::tbb::auto_partitioner>() {
+  return "Auto";
+}
+template <>
+const char* partitionerName<oneapi::tbb::simple_partitioner>() {
+  return "Simple";
+}
+template <>
+const char* partitionerName<oneapi::tbb::static_partitioner>() {
+  return "Static";
+}
+template <>
+const char* partitionerName<oneapi::tbb::affinity_partitioner>() {
+  return "Affinity";
+}
+
+// The TBB benchmarks limit the scheduler to the thread count for their whole
+// run, so that limiting it is not part of the time.
+template <typename Partitioner>
+static void benchOverheadTbbParallelFor(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  global_control threads(global_control::max_allowed_parallelism,
+                         state.range(0));
+  ContainerType X(Elements, 1);
+  ValueType* x = X.data();
+  Partitioner part;
+  timeCalls(state, [&] {
+    parallel_for(
+        blocked_range<IndexType>(0, Elements),
+        [x](const blocked_range<IndexType>& r) {
+          for (IndexType i = r.begin(); i < r.end(); ++i) x[i] += 1;
+        },
+        part);
+    benchmark::ClobberMemory();
+  });
+  setCustomCounter(state, std::string("TbbParallelFor") +
+                              partitionerName<Partitioner>());
+}
+
+template <typename Partitioner>
+static void benchOverheadTbbParallelReduce(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  global_control threads(global_control::max_allowed_parallelism,
+                         state.range(0));
+  ContainerType X(Elements, 1);
+  const ValueType* x = X.data();
+  Partitioner part;
+  ValueType sum;
+  timeCalls(state, [&] {
+    sum = parallel_reduce(
+        blocked_range<IndexType>(0, Elements), ValueType{0},
+        [x](const blocked_range<IndexType>& r, ValueType acc) {
+          for (IndexType i = r.begin(); i < r.end(); ++i) acc += x[i];
+          return acc;
+        },
+        std::plus<ValueType>(), part);
+    benchmark::DoNotOptimize(&sum);
+  });
+  setCustomCounter(state, std::string("TbbParallelReduce") +
+                              partitionerName<Partitioner>());
+}
+
+// Entering an arena of the given size that is already initialized, as the
+// ex05 kernels do for every call through ArenaMgtTBB, without and with a
+// parallel_for inside.
+static void benchOverheadTbbArenaExecute(benchmark::State& state) {
+  oneapi::tbb::task_arena arena(state.range(0));
+  arena.initialize();
+  timeCalls(state, [&] { arena.execute([] { benchmark::ClobberMemory(); }); });
+  setCustomCounter(state, "TbbArenaExecute");
+}
+
+static void benchOverheadTbbArenaExecuteFor(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  task_arena arena(state.range(0));
+  arena.initialize();
+  ContainerType X(Elements, 1);
+  ValueType* x = X.data();
+  static_partitioner part;
+  timeCalls(state, [&] {
+    arena.execute([&] {
+      parallel_for(
+          blocked_range<IndexType>(0, Elements),
+          [x](const blocked_range<IndexType>& r) {
+            for (IndexType i = r.begin(); i < r.end(); ++i) x[i] += 1;
+          },
+          part);
+    });
+    benchmark::ClobberMemory();
+  });
+  setCustomCounter(state, "TbbArenaExecuteFor");
+}
+
+// OpenMP team of one thread per NUMA node, each entering its node's arena,
+// the pattern of ex05's V3 kernels; and pad's own per-node fan-out. Both
+// use the pad::numa arenas, so the thread argument does not apply.
+static void benchOverheadOmpArenaPerNode(benchmark::State& state) {
+  const int nodes = pad::numa::node_count();
+  timeCalls(state, [&] {
+#pragma omp parallel num_threads(nodes)
+    pad::numa::arena(omp_get_thread_num()).execute([] {
+      benchmark::ClobberMemory();
+    });
+  });
+  setCustomCounter(state, "OmpArenaPerNode");
+  state.counters["Threads"] = nodes;
+}
+
+static void benchOverheadNumaForEachNode(benchmark::State& state) {
+  timeCalls(state, [&] {
+    pad::numa::for_each_node(Elements, [](int, IndexType, IndexType) {
+      benchmark::ClobberMemory();
+    });
+  });
+  setCustomCounter(state, "NumaForEachNode");
+  state.counters["Threads"] = pad::numa::node_count();
+}
+
+// libstdc++ runs the parallel algorithms on TBB, so global_control limits
+// them too.
+static void benchOverheadStdParForEach(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  global_control threads(global_control::max_allowed_parallelism,
+                         state.range(0));
+  ContainerType X(Elements, 1);
+  timeCalls(state, [&] {
+    std::for_each(std::execution::par, X.begin(), X.end(),
+                  [](ValueType& x) { x += 1; });
+    benchmark::ClobberMemory();
+  });
+  setCustomCounter(state, "StdParForEach");
+}
+
+static void benchOverheadStdParReduce(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  global_control threads(global_control::max_allowed_parallelism,
+                         state.range(0));
+  ContainerType X(Elements, 1);
+  ValueType sum;
+  timeCalls(state, [&] {
+    sum = std::reduce(std::execution::par, X.begin(), X.end());
+    benchmark::DoNotOptimize(&sum);
+  });
+  setCustomCounter(state, "StdParReduce");
+}
+
+BENCHMARK(benchOverheadOmpParallel)->Apply(ThreadArgs)->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadOmpFor, Schedule::Static)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadOmpFor, Schedule::Dynamic)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadOmpFor, Schedule::Guided)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadOmpFor, Schedule::Auto)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK(benchOverheadOmpTaskloop)->Apply(ThreadArgs)->UseManualTime();
+
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelFor, oneapi::tbb::auto_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelFor, oneapi::tbb::simple_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelFor, oneapi::tbb::static_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelFor,
+                   oneapi::tbb::affinity_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelReduce,
+                   oneapi::tbb::auto_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelReduce,
+                   oneapi::tbb::simple_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelReduce,
+                   oneapi::tbb::static_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(benchOverheadTbbParallelReduce,
+                   oneapi::tbb::affinity_partitioner)
+    ->Apply(ThreadArgs)
+    ->UseManualTime();
+
+BENCHMARK(benchOverheadTbbArenaExecute)->Apply(ThreadArgs)->UseManualTime();
+BENCHMARK(benchOverheadTbbArenaExecuteFor)->Apply(ThreadArgs)->UseManualTime();
+BENCHMARK(benchOverheadOmpArenaPerNode)->Arg(0)->UseManualTime();
+BENCHMARK(benchOverheadNumaForEachNode)->Arg(0)->UseManualTime();
+
+BENCHMARK(benchOverheadStdParForEach)->Apply(ThreadArgs)->UseManualTime();
+BENCHMARK(benchOverheadStdParReduce)->Apply(ThreadArgs)->UseManualTime();
+PAD_BENCHMARK_MAIN();
@@ -1,6 +1,9 @@
 #include <benchmark/benchmark.h>  // google benchmark 
 #include <umesimd/UMESimd.h>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <execution>
 #include <numeric>
 #include <iostream>
@@ -11,6 +14,8 @@
 #include "range/v3/view.hpp"
 #include "omp.h"
 #include "oneapi/tbb.h"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using IndexType = ssize_t;
 using ValueType = float;
@@ -25,6 +30,19 @@ static void Args(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Args plus sizes that are not a multiple of simd_width, for the kernels
+// that handle a tail
+static void TailArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 15;
+  const auto upperLimit = 30;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+    b->Args({(1 << x) + 1});
+    b->Args({(1 << x) + 7});
+  }
+}
+
 static void GrainSizeArgs(benchmark::internal::Benchmark* b) {
   const auto lowerLimit = 25;
   const auto upperLimit = 25;
@@ -37,47 +55,66 @@ static void GrainSizeArgs(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Problem size times OpenMP chunk size in elements, the counterpart of
+// GrainSizeArgs
+static void ChunkSizeArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 25;
+  const auto upperLimit = 25;
+  const auto cLow = 0;
+  const auto cHigh = 16;
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    for (auto y = cLow; y <= cHigh; ++y) {
+      b->Args({1 << x, 1 << y});
+    }
+  }
+}
+
 void setCustomCounter(benchmark::State& state, std::string name) {
   state.counters["Elements"] = state.range(0);
   state.counters["Bytes"] = state.range(0) * sizeof(ValueType);
   state.SetLabel(name);
 }
 
-// TODO
-// change the code such that elements = std::distance(Xbegin, Xend) is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
-template <typename Iter, typename Partitioner>
-typename std::iterator_traits<Iter>::value_type reduceTbb(Iter Xbegin,
-                                                          Iter Xend,
-                                                          Partitioner& part,
-                                                          int grain_size = 1) {
-  using value_type = typename std::iterator_traits<Iter>::value_type;
-  using index_type = typename std::iterator_traits<Iter>::difference_type;
-  constexpr index_type simd_width = 8;
-  using simd_value_type = std::array<value_type, simd_width>;
-  using namespace oneapi::tbb;
-  auto elements = std::distance(Xbegin, Xend)/simd_width;
-  
-  simd_value_type simd_sum = parallel_reduce(
-      blocked_range<index_type>(0, elements, grain_size), simd_value_type{0},
-      [&](blocked_range<index_type>& r, simd_value_type simd_acc) {
-        for (auto u = r.begin(); u != r.end(); ++u) {
-	      auto U = u * simd_width;
-#pragma omp simd
-	      for (index_type i = 0; i < simd_width; ++i) {
-            simd_acc[i] += Xbegin[U+i];
-	      }		  
-        }
-        return simd_acc;
-      },
-      [](simd_value_type x, simd_value_type y) -> simd_value_type {
-        simd_value_type sum;
-#pragma omp simd
-        for (int i = 0; i < simd_width; i++) sum[i] = x[i] + y[i];
-        return sum;
-      }, part);
-  ValueType sum = std::reduce(std::execution::unseq, simd_sum.begin(), simd_sum.end());
-  return sum;
+// Steals and tasks of a pad::ws pool per call, next to the time
+void setStealCounters(benchmark::State& state, const pad::ws::pool& pool) {
+  const auto stats = pool.stats();
+  const double calls = std::max<double>(state.iterations(), 1);
+  state.counters["Steals"] = stats.steals / calls;
+  state.counters["FailedSteals"] = stats.failed_steals / calls;
+  state.counters["Tasks"] = stats.tasks / calls;
+}
+
+const char* stealOrderName(pad::ws::steal_order order) {
+  return order == pad::ws::steal_order::random ? "WsRandomSteal"
+                                               : "WsNumaLocalFirstSteal";
+}
+
+enum class Schedule { Static, Dynamic, Guided, NonmonotonicDynamic };
+
+const char* scheduleName(Schedule s) {
+  switch (s) {
+    case Schedule::Static:
+      return "ScheduleStatic";
+    case Schedule::Dynamic:
+      return "ScheduleDynamic";
+    case Schedule::Guided:
+      return "ScheduleGuided";
+    default:
+      return "ScheduleNonmonotonicDynamic";
+  }
+}
+
+// OMP_SCHEDULE as schedule(runtime) sees it
+std::string runtimeScheduleName() {
+  omp_sched_t kind;
+  int chunk;
+  omp_get_schedule(&kind, &chunk);
+  const char* names[] = {"", "static", "dynamic", "guided", "auto"};
+  const int k =
+      static_cast<int>(kind) & ~static_cast<int>(omp_sched_monotonic);
+  const char* name = k >= 1 && k <= 4 ? names[k] : "?";
+  return std::string("ScheduleRuntime(") + name + "," +
+         std::to_string(chunk) + ")";
 }
 
 // Ex 3.1.1
@@ -129,6 +166,78 @@ static void benchReduceIteratorScheduleGuided(benchmark::State& state) {
   setCustomCounter(state, "IteratorGuided");
 }
 
+// Ex 3.1.1 with an explicit chunk size, state.range(1) elements
+template <Schedule S>
+static void benchReduceScheduleChunk(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const ValueType* x = X.data();
+  const IndexType n = state.range(0);
+  const int chunk = state.range(1);
+  ValueType sum;
+  for (auto _ : state) {
+    sum = 0;
+    if constexpr (S == Schedule::Static) {
+#pragma omp parallel for simd reduction(+ : sum) schedule(static, chunk)
+      for (IndexType i = 0; i < n; ++i) sum += x[i];
+    } else if constexpr (S == Schedule::Dynamic) {
+#pragma omp parallel for simd reduction(+ : sum) schedule(dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) sum += x[i];
+    } else if constexpr (S == Schedule::Guided) {
+#pragma omp parallel for simd reduction(+ : sum) schedule(guided, chunk)
+      for (IndexType i = 0; i < n; ++i) sum += x[i];
+    } else {
+#pragma omp parallel for simd reduction(+ : sum) \
+    schedule(nonmonotonic : dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) sum += x[i];
+    }
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["ChunkSize"] = chunk;
+  setCustomCounter(state, scheduleName(S));
+}
+
+// schedule(runtime): kind and chunk come from OMP_SCHEDULE, e.g.
+// OMP_SCHEDULE="dynamic,4096"
+static void benchReduceScheduleRuntime(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const ValueType* x = X.data();
+  const IndexType n = state.range(0);
+  ValueType sum;
+  for (auto _ : state) {
+    sum = 0;
+#pragma omp parallel for simd reduction(+ : sum) schedule(runtime)
+    for (IndexType i = 0; i < n; ++i) sum += x[i];
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, runtimeScheduleName());
+}
+
+// One task per state.range(1) elements, created by a single thread of the
+// team
+static void benchReduceTaskloopGrainSize(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const ValueType* x = X.data();
+  const IndexType n = state.range(0);
+  const IndexType grain = state.range(1);
+  ValueType sum;
+  for (auto _ : state) {
+    sum = 0;
+#pragma omp parallel
+#pragma omp single
+#pragma omp taskloop simd grainsize(grain) reduction(+ : sum)
+    for (IndexType i = 0; i < n; ++i) sum += x[i];
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = grain;
+  setCustomCounter(state, "TaskloopGrainSize");
+}
+
 static void benchReduceRange(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
@@ -188,18 +297,130 @@ static void benchReduceStl2(benchmark::State& state) {
   setCustomCounter(state, "Stl2");
 }
 
+static void benchReduceOmp(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(pad::exec::omp, X.begin(), X.end());
+    benchmark::DoNotOptimize(X.data());
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "Omp");
+}
+
 static void benchReduceTbb(benchmark::State& state) {
   ContainerType X(state.range(0));
   std::iota(X.begin(), X.end(), ValueType{1});
   oneapi::tbb::auto_partitioner part;
   for (auto _ : state) {
-    ValueType sum = reduceTbb(X.begin(), X.end(), part);
+    ValueType sum = pad::reduce(pad::exec::tbb, X.begin(), X.end(), part);
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "Tbb");
 }
 
+template <typename T>
+static const char* typeName() {
+  if constexpr (std::is_same_v<T, float>) return "float";
+  if constexpr (std::is_same_v<T, double>) return "double";
+  if constexpr (std::is_same_v<T, std::int32_t>) return "int32";
+  if constexpr (std::is_same_v<T, std::int64_t>) return "int64";
+  return "uint8";
+}
+
+template <typename Op>
+static const char* opName() {
+  if constexpr (std::is_same_v<Op, std::plus<>>) return "plus";
+  if constexpr (std::is_same_v<Op, std::multiplies<>>) return "multiplies";
+  if constexpr (std::is_same_v<Op, pad::minimum>) return "min";
+  return "max";
+}
+
+// Any associative Op over any arithmetic T, one vector register of T per
+// accumulator at the ISA level pad picked at startup (4 doubles or 32 uint8
+// with AVX2). Integer sums and products wrap; only the throughput matters.
+template <typename T, typename Op>
+static void benchReduceTbbOp(benchmark::State& state) {
+  std::vector<T> X(state.range(0));
+  std::iota(X.begin(), X.end(), T{1});
+  oneapi::tbb::auto_partitioner part;
+  const T identity = pad::identity<T>(Op{});
+  T result;
+  for (auto _ : state) {
+    result = pad::reduce(pad::exec::tbb, X.begin(), X.end(), identity, Op{},
+                         part);
+    benchmark::DoNotOptimize(&result);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbOp-") + typeName<T>() + "-" +
+                              opName<Op>());
+  state.counters["Bytes"] = state.range(0) * sizeof(T);
+}
+
+// Fixed blocks summed in a fixed tree: the same bits for every thread count
+// and partitioner, at the price of one pass over the block sums
+static void benchReduceTbbDeterministic(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  oneapi::tbb::auto_partitioner part;
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(pad::exec::deterministic(pad::exec::tbb),
+                                X.begin(), X.end(), part);
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "TbbDeterministic");
+}
+
+// Kahan, Neumaier, pairwise or double accumulation inside every chunk, the
+// chunks joined with Neumaier's correction. RelError is against the exact
+// sum of X.
+template <pad::exec::summation Method>
+static void benchReduceTbbAccurate(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  const auto policy = pad::exec::accurate(pad::exec::tbb, Method);
+  oneapi::tbb::auto_partitioner part;
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(policy, X.begin(), X.end(), part);
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  const long double exact = std::accumulate(X.begin(), X.end(), 0.0L);
+  state.counters["RelError"] =
+      static_cast<double>(std::abs((sum - exact) / exact));
+  setCustomCounter(state, std::string("TbbAccurate-") + pad::exec::name(Method));
+}
+
+static void benchReduceOmpDeterministic(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  ValueType sum;
+  for (auto _ : state) {
+    sum = pad::reduce(pad::exec::deterministic(pad::exec::omp), X.begin(),
+                      X.end());
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "OmpDeterministic");
+}
+
+// No partitioner: pad picks the one pad-tune-tbb cached for this host
+static void benchReduceTbbTuned(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(pad::exec::tbb, X.begin(), X.end());
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "TbbTuned");
+}
+
 // Ex 3.2
 // TODO
 // Performance differences between partitioners
@@ -210,7 +431,8 @@ static void benchReduceTbbGrainSizeAuto(benchmark::State& state) {
   std::iota(X.begin(), X.end(), ValueType{1});
   oneapi::tbb::auto_partitioner part;
   for (auto _ : state) {
-    ValueType sum = reduceTbb(X.begin(), X.end(), part, state.range(1));
+    ValueType sum =
+        pad::reduce(pad::exec::tbb, X.begin(), X.end(), part, state.range(1));
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
@@ -222,7 +444,8 @@ static void benchReduceTbbGrainSizeSimple(benchmark::State& state) {
   std::iota(X.begin(), X.end(), ValueType{1});
   oneapi::tbb::simple_partitioner part;
   for (auto _ : state) {
-    ValueType sum = reduceTbb(X.begin(), X.end(), part, state.range(1));
+    ValueType sum =
+        pad::reduce(pad::exec::tbb, X.begin(), X.end(), part, state.range(1));
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
@@ -234,7 +457,8 @@ static void benchReduceTbbGrainSizeAffinity(benchmark::State& state) {
   std::iota(X.begin(), X.end(), ValueType{1});
   oneapi::tbb::affinity_partitioner part;
   for (auto _ : state) {
-    ValueType sum = reduceTbb(X.begin(), X.end(), part, state.range(1));
+    ValueType sum =
+        pad::reduce(pad::exec::tbb, X.begin(), X.end(), part, state.range(1));
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
@@ -246,25 +470,127 @@ static void benchReduceTbbGrainSizeStatic(benchmark::State& state) {
   std::iota(X.begin(), X.end(), ValueType{1});
   oneapi::tbb::static_partitioner part;
   for (auto _ : state) {
-    ValueType sum = reduceTbb(X.begin(), X.end(), part, state.range(1));
+    ValueType sum =
+        pad::reduce(pad::exec::tbb, X.begin(), X.end(), part, state.range(1));
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "TbbStaticPartitioner");
 }
 
+// pad's work-stealing pool in place of TBB; grain_size counts simd_width
+// blocks as for reduceTbb
+template <pad::ws::steal_order Order>
+static void benchReduceWsGrainSize(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  pad::ws::pool pool(0, Order);
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(pad::exec::on(pool), X.begin(), X.end(),
+                                state.range(1));
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = state.range(1);
+  setStealCounters(state, pool);
+  setCustomCounter(state, stealOrderName(Order));
+}
+
+// Chunks sized to half the per-core share of the L2 or L3 cache, in whole
+// vectors and cache lines; grain_size only raises the chunk.
+template <pad::cache_level Level>
+static void benchReduceTbbGrainSizeCache(benchmark::State& state) {
+  ContainerType X(state.range(0));
+  std::iota(X.begin(), X.end(), ValueType{1});
+  pad::cache_partitioner part(Level);
+  for (auto _ : state) {
+    ValueType sum =
+        pad::reduce(pad::exec::tbb, X.begin(), X.end(), part, state.range(1));
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = state.range(1);
+  state.counters["Chunk"] = part.chunk<ValueType>(1);
+  setCustomCounter(state, Level == pad::cache_level::l2
+                              ? "TbbCacheL2Partitioner"
+                              : "TbbCacheL3Partitioner");
+}
+
 
 BENCHMARK(benchReduceStl)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceStl2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceIteratorScheduleStatic)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceIteratorScheduleDynamic)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceIteratorScheduleGuided)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceScheduleChunk, Schedule::Static)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceScheduleChunk, Schedule::Dynamic)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceScheduleChunk, Schedule::Guided)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceScheduleChunk, Schedule::NonmonotonicDynamic)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK(benchReduceScheduleRuntime)->Apply(Args)->UseRealTime();
+BENCHMARK(benchReduceTaskloopGrainSize)->Apply(ChunkSizeArgs)->UseRealTime();
 BENCHMARK(benchReduceRange)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceRangeFor)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceTbb)->Apply(Args)->UseRealTime();
+BENCHMARK(benchReduceOmp)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceTbb)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceTbbTuned)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceOmpDeterministic)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchReduceTbbDeterministic)->Apply(TailArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbAccurate, pad::exec::summation::kahan)
+    ->Apply(TailArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbAccurate, pad::exec::summation::neumaier)
+    ->Apply(TailArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbAccurate, pad::exec::summation::pairwise)
+    ->Apply(TailArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbAccurate, pad::exec::summation::widened)
+    ->Apply(TailArgs)
+    ->UseRealTime();
 
 BENCHMARK(benchReduceTbbGrainSizeAuto)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchReduceTbbGrainSizeSimple)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchReduceTbbGrainSizeStatic)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchReduceTbbGrainSizeAffinity)->Apply(GrainSizeArgs)->UseRealTime();
-BENCHMARK_MAIN();
+BENCHMARK_TEMPLATE(benchReduceWsGrainSize, pad::ws::steal_order::random)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceWsGrainSize,
+                   pad::ws::steal_order::numa_local_first)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbGrainSizeCache, pad::cache_level::l2)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbGrainSizeCache, pad::cache_level::l3)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+// + min max and * for every value type, over the same sizes as the float sums
+#define PAD_TYPED_REDUCE_BENCHMARKS(T)                                        \
+  BENCHMARK_TEMPLATE2(benchReduceTbbOp, T, std::plus<>)                      \
+      ->Apply(TailArgs)                                                      \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceTbbOp, T, std::multiplies<>)                \
+      ->Apply(TailArgs)                                                      \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceTbbOp, T, pad::minimum)                     \
+      ->Apply(TailArgs)                                                      \
+      ->UseRealTime();                                                       \
+  BENCHMARK_TEMPLATE2(benchReduceTbbOp, T, pad::maximum)                     \
+      ->Apply(TailArgs)                                                      \
+      ->UseRealTime()
+
+PAD_TYPED_REDUCE_BENCHMARKS(float);
+PAD_TYPED_REDUCE_BENCHMARKS(double);
+PAD_TYPED_REDUCE_BENCHMARKS(std::int32_t);
+PAD_TYPED_REDUCE_BENCHMARKS(std::int64_t);
+PAD_TYPED_REDUCE_BENCHMARKS(std::uint8_t);
+PAD_BENCHMARK_MAIN();
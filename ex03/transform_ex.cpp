@@ -11,6 +11,8 @@
 #include "range/v3/view.hpp"
 #include "omp.h"
 #include "oneapi/tbb.h"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using IndexType = ssize_t;
 using ValueType = float;
@@ -25,6 +27,29 @@ static void Args(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Args plus sizes that are not a multiple of simd_width, for the kernels
+// that handle a tail
+static void TailArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 15;
+  const auto upperLimit = 30;
+
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    b->Args({1 << x});
+    b->Args({(1 << x) + 1});
+    b->Args({(1 << x) + 7});
+  }
+}
+
+// DRAM-resident sizes with a prefetch distance in elements; 0 turns the
+// software prefetch off
+static void PrefetchArgs(benchmark::internal::Benchmark* b) {
+  for (auto x = 24; x <= 30; x += 2) {
+    for (auto distance : {0, 64, 128, 256, 512, 1024, 2048, 4096, 16384}) {
+      b->Args({1 << x, distance});
+    }
+  }
+}
+
 static void GrainSizeArgs(benchmark::internal::Benchmark* b) {
   const auto lowerLimit = 28;
   const auto upperLimit = 28;
@@ -37,31 +62,66 @@ static void GrainSizeArgs(benchmark::internal::Benchmark* b) {
   }
 }
 
+// Problem size times OpenMP chunk size in elements, the counterpart of
+// GrainSizeArgs
+static void ChunkSizeArgs(benchmark::internal::Benchmark* b) {
+  const auto lowerLimit = 25;
+  const auto upperLimit = 25;
+  const auto cLow = 0;
+  const auto cHigh = 16;
+  for (auto x = lowerLimit; x <= upperLimit; ++x) {
+    for (auto y = cLow; y <= cHigh; ++y) {
+      b->Args({1 << x, 1 << y});
+    }
+  }
+}
+
 void setCustomCounter(benchmark::State& state, std::string name) {
   state.counters["Elements"] = state.range(0);
   state.counters["Bytes"] = 3 * state.range(0) * sizeof(ValueType);
   state.SetLabel(name);
 }
 
-template <typename Constant, typename Iter, typename Partitioner>
-void transformTbb(Constant a,
-                  Iter Xbegin,
-                  Iter Xend,
-                  Iter Ybegin,
-                  Partitioner& part,
-                  int grain_size = 1) {
-  using index_type = typename std::iterator_traits<Iter>::difference_type;
-  using namespace oneapi::tbb;
-  auto elements = std::distance(Xbegin, Xend);
-  parallel_for(
-      blocked_range<index_type>(0, elements, grain_size),
-      [&](const blocked_range<index_type>& r) {
-#pragma omp simd
-        for (auto i = r.begin(); i != r.end(); ++i) {
-          Ybegin[i] = a * Xbegin[i] + Ybegin[i];
-        }
-      },
-      part);
+// Steals and tasks of a pad::ws pool per call, next to the time
+void setStealCounters(benchmark::State& state, const pad::ws::pool& pool) {
+  const auto stats = pool.stats();
+  const double calls = std::max<double>(state.iterations(), 1);
+  state.counters["Steals"] = stats.steals / calls;
+  state.counters["FailedSteals"] = stats.failed_steals / calls;
+  state.counters["Tasks"] = stats.tasks / calls;
+}
+
+const char* stealOrderName(pad::ws::steal_order order) {
+  return order == pad::ws::steal_order::random ? "WsRandomSteal"
+                                               : "WsNumaLocalFirstSteal";
+}
+
+enum class Schedule { Static, Dynamic, Guided, NonmonotonicDynamic };
+
+const char* scheduleName(Schedule s) {
+  switch (s) {
+    case Schedule::Static:
+      return "ScheduleStatic";
+    case Schedule::Dynamic:
+      return "ScheduleDynamic";
+    case Schedule::Guided:
+      return "ScheduleGuided";
+    default:
+      return "ScheduleNonmonotonicDynamic";
+  }
+}
+
+// OMP_SCHEDULE as schedule(runtime) sees it
+std::string runtimeScheduleName() {
+  omp_sched_t kind;
+  int chunk;
+  omp_get_schedule(&kind, &chunk);
+  const char* names[] = {"", "static", "dynamic", "guided", "auto"};
+  const int k =
+      static_cast<int>(kind) & ~static_cast<int>(omp_sched_monotonic);
+  const char* name = k >= 1 && k <= 4 ? names[k] : "?";
+  return std::string("ScheduleRuntime(") + name + "," +
+         std::to_string(chunk) + ")";
 }
 
 // Ex 3.1.1
@@ -113,6 +173,74 @@ static void benchTransformIteratorScheduleGuided(benchmark::State& state) {
   setCustomCounter(state, "IteratorGuided");
 }
 
+// Ex 3.1.1 with an explicit chunk size, state.range(1) elements
+template <Schedule S>
+static void benchTransformScheduleChunk(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const ValueType* x = X.data();
+  ValueType* y = Y.data();
+  const IndexType n = state.range(0);
+  const int chunk = state.range(1);
+  for (auto _ : state) {
+    if constexpr (S == Schedule::Static) {
+#pragma omp parallel for simd schedule(static, chunk)
+      for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    } else if constexpr (S == Schedule::Dynamic) {
+#pragma omp parallel for simd schedule(dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    } else if constexpr (S == Schedule::Guided) {
+#pragma omp parallel for simd schedule(guided, chunk)
+      for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    } else {
+#pragma omp parallel for simd schedule(nonmonotonic : dynamic, chunk)
+      for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    }
+    benchmark::ClobberMemory();
+  }
+  state.counters["ChunkSize"] = chunk;
+  setCustomCounter(state, scheduleName(S));
+}
+
+// schedule(runtime): kind and chunk come from OMP_SCHEDULE, e.g.
+// OMP_SCHEDULE="dynamic,4096"
+static void benchTransformScheduleRuntime(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const ValueType* x = X.data();
+  ValueType* y = Y.data();
+  const IndexType n = state.range(0);
+  for (auto _ : state) {
+#pragma omp parallel for simd schedule(runtime)
+    for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, runtimeScheduleName());
+}
+
+// One task per state.range(1) elements, created by a single thread of the
+// team
+static void benchTransformTaskloopGrainSize(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  const ValueType* x = X.data();
+  ValueType* y = Y.data();
+  const IndexType n = state.range(0);
+  const IndexType grain = state.range(1);
+  for (auto _ : state) {
+#pragma omp parallel
+#pragma omp single
+#pragma omp taskloop simd grainsize(grain)
+    for (IndexType i = 0; i < n; ++i) y[i] = a * x[i] + y[i];
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = grain;
+  setCustomCounter(state, "TaskloopGrainSize");
+}
+
 static void benchTransformRange(benchmark::State& state) {
   ValueType a = -1;
   ContainerType X(state.range(0), 1);
@@ -153,10 +281,23 @@ static void benchTransformRangeInnerLoop2(benchmark::State& state) {
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
 
+  const int64_t body = state.range(0) / simd_width;
+  const IndexType rest = state.range(0) % simd_width;
+
   for (auto _ : state) {
-// TODO
-// like RangeInnerLoop, but X.size() is not necessarily a multiple of simd_width
-// do not put any if-statements into loops
+#pragma omp parallel for
+    for (auto u : ranges::iota_view<int64_t, int64_t>(0, body)) {
+      auto U = u * simd_width;
+#pragma omp simd
+      for (IndexType i = 0; i < simd_width; ++i) {
+        Y[U + i] = a * X[U + i] + Y[U + i];
+      }
+    }
+    const IndexType U = body * simd_width;
+#pragma omp simd
+    for (IndexType i = 0; i < rest; ++i) {
+      Y[U + i] = a * X[U + i] + Y[U + i];
+    }
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "RangeInnerLoop2");
@@ -192,18 +333,56 @@ static void benchTransformStl2(benchmark::State& state) {
   setCustomCounter(state, "Stl2");
 }
 
+static void benchTransformOmp(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  for (auto _ : state) {
+    pad::transform(pad::exec::omp, a, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "Omp");
+}
+
 // Ex 1.1.2
 static void benchTransformTbb(benchmark::State& state) {
   ContainerType X(state.range(0), 1);
   ContainerType Y(state.range(0), 2);
   oneapi::tbb::auto_partitioner part;
   for (auto _ : state) {
-    transformTbb(-1, X.begin(), X.end(), Y.begin(), part);
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
   setCustomCounter(state, "Tbb");
 }
 
+// No partitioner: pad picks the one pad-tune-tbb cached for this host
+static void benchTransformTbbTuned(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  for (auto _ : state) {
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin());
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, "TbbTuned");
+}
+
+// Tbb with software prefetch, distance from state.range(1)
+static void benchTransformTbbPrefetch(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  oneapi::tbb::auto_partitioner part;
+  const auto policy = pad::exec::prefetch(pad::exec::tbb, state.range(1));
+  for (auto _ : state) {
+    pad::transform(policy, -1, X.begin(), X.end(), Y.begin(), part);
+    benchmark::ClobberMemory();
+  }
+  state.counters["Distance"] = state.range(1);
+  state.SetBytesProcessed(state.iterations() * 3 * state.range(0) *
+                          sizeof(ValueType));
+  setCustomCounter(state, "TbbPrefetch");
+}
+
 // Ex 3.2
 // TODO
 // Performance differences between partitioners
@@ -214,7 +393,8 @@ static void benchTransformTbbGrainSizeStatic(benchmark::State& state) {
   ContainerType Y(state.range(0), 2);
   oneapi::tbb::static_partitioner part;
   for (auto _ : state) {
-    transformTbb(-1, X.begin(), X.end(), Y.begin(), part, state.range(1));
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part,
+                   state.range(1));
     benchmark::ClobberMemory();
   }
   state.counters["GrainSize"] = state.range(1);
@@ -226,7 +406,8 @@ static void benchTransformTbbGrainSizeAuto(benchmark::State& state) {
   ContainerType Y(state.range(0), 2);
   oneapi::tbb::auto_partitioner part;
   for (auto _ : state) {
-    transformTbb(-1, X.begin(), X.end(), Y.begin(), part, state.range(1));
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part,
+                   state.range(1));
     benchmark::ClobberMemory();
   }
   state.counters["GrainSize"] = state.range(1);
@@ -238,7 +419,8 @@ static void benchTransformTbbGrainSizeAffinity(benchmark::State& state) {
   ContainerType Y(state.range(0), 2);
   oneapi::tbb::affinity_partitioner part;
   for (auto _ : state) {
-    transformTbb(-1, X.begin(), X.end(), Y.begin(), part, state.range(1));
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part,
+                   state.range(1));
     benchmark::ClobberMemory();
   }
   state.counters["GrainSize"] = state.range(1);
@@ -250,25 +432,93 @@ static void benchTransformTbbGrainSizeSimple(benchmark::State& state) {
   ContainerType Y(state.range(0), 2);
   oneapi::tbb::simple_partitioner part;
   for (auto _ : state) {
-    transformTbb(-1, X.begin(), X.end(), Y.begin(), part, state.range(1));
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part,
+                   state.range(1));
     benchmark::ClobberMemory();
   }
   state.counters["GrainSize"] = state.range(1);
   setCustomCounter(state, "TbbSimplePartitioner");
 }
 
+// pad's work-stealing pool in place of TBB; grain_size counts elements
+template <pad::ws::steal_order Order>
+static void benchTransformWsGrainSize(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  pad::ws::pool pool(0, Order);
+  for (auto _ : state) {
+    pad::transform(pad::exec::on(pool), -1, X.begin(), X.end(), Y.begin(),
+                   state.range(1));
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = state.range(1);
+  setStealCounters(state, pool);
+  setCustomCounter(state, stealOrderName(Order));
+}
+
+// Chunks sized to half the per-core share of the L2 or L3 cache over X and
+// Y, in whole vectors and cache lines; grain_size only raises the chunk.
+template <pad::cache_level Level>
+static void benchTransformTbbGrainSizeCache(benchmark::State& state) {
+  ContainerType X(state.range(0), 1);
+  ContainerType Y(state.range(0), 2);
+  pad::cache_partitioner part(Level);
+  for (auto _ : state) {
+    pad::transform(pad::exec::tbb, -1, X.begin(), X.end(), Y.begin(), part,
+                   state.range(1));
+    benchmark::ClobberMemory();
+  }
+  state.counters["GrainSize"] = state.range(1);
+  state.counters["Chunk"] = part.chunk<ValueType>(2);
+  setCustomCounter(state, Level == pad::cache_level::l2
+                              ? "TbbCacheL2Partitioner"
+                              : "TbbCacheL3Partitioner");
+}
+
 BENCHMARK(benchTransformIteratorScheduleStatic)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformIteratorScheduleDynamic)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformIteratorScheduleGuided)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformScheduleChunk, Schedule::Static)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformScheduleChunk, Schedule::Dynamic)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformScheduleChunk, Schedule::Guided)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformScheduleChunk, Schedule::NonmonotonicDynamic)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
+BENCHMARK(benchTransformScheduleRuntime)->Apply(Args)->UseRealTime();
+BENCHMARK(benchTransformTaskloopGrainSize)
+    ->Apply(ChunkSizeArgs)
+    ->UseRealTime();
 BENCHMARK(benchTransformRange)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformRangeInnerLoop)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformRangeInnerLoop2)->Apply(Args)->UseRealTime();
+BENCHMARK(benchTransformRangeInnerLoop2)->Apply(TailArgs)->UseRealTime();
 BENCHMARK(benchTransformStl)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformStl2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbb)->Apply(Args)->UseRealTime();
+BENCHMARK(benchTransformOmp)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformTbb)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformTbbTuned)->Apply(TailArgs)->UseRealTime();
+BENCHMARK(benchTransformTbbPrefetch)->Apply(PrefetchArgs)->UseRealTime();
 
 BENCHMARK(benchTransformTbbGrainSizeAuto)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchTransformTbbGrainSizeStatic)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchTransformTbbGrainSizeAffinity)->Apply(GrainSizeArgs)->UseRealTime();
 BENCHMARK(benchTransformTbbGrainSizeSimple)->Apply(GrainSizeArgs)->UseRealTime();
-BENCHMARK_MAIN();
+BENCHMARK_TEMPLATE(benchTransformWsGrainSize, pad::ws::steal_order::random)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformWsGrainSize,
+                   pad::ws::steal_order::numa_local_first)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbGrainSizeCache, pad::cache_level::l2)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbGrainSizeCache, pad::cache_level::l3)
+    ->Apply(GrainSizeArgs)
+    ->UseRealTime();
+PAD_BENCHMARK_MAIN();
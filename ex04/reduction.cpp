@@ -2,6 +2,7 @@
 #include <umesimd/UMESimd.h>
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <execution>
 #include <iostream>
 // #include <iterator>
@@ -9,9 +10,13 @@
 #include <string>
 #include <utility>
 #include <vector>
-#include "allocator_adaptor.hpp"
+#include <sys/resource.h>
+#include "pad/allocator.hpp"
+#include "pad/first_touch.hpp"
 #include "omp.h"
 #include "oneapi/tbb.h"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 #include "range/v3/view.hpp"
 
 using IndexType = ssize_t;
@@ -21,6 +26,45 @@ using ContainerTypeDefaultInit =
     std::vector<ValueType, numa::default_init_allocator<ValueType>>;
 using ContainerTypeNoInit =
     std::vector<ValueType, numa::no_init_allocator<ValueType>>;
+using MembindAllocator =
+    numa::no_init_allocator<ValueType, numa::membind_allocator<ValueType>>;
+using ContainerTypeMembind = std::vector<ValueType, MembindAllocator>;
+using HugePageAllocator =
+    numa::no_init_allocator<ValueType, numa::huge_page_allocator<ValueType>>;
+using ContainerTypeHugePages = std::vector<ValueType, HugePageAllocator>;
+
+// The same containers with their first element on a cache line
+using AlignedAllocator = numa::aligned_allocator<ValueType>;
+using ContainerTypeAligned = std::vector<ValueType, AlignedAllocator>;
+using ContainerTypeDefaultInitAligned = std::vector<
+    ValueType, numa::default_init_allocator<ValueType, AlignedAllocator>>;
+using ContainerTypeNoInitAligned = std::vector<
+    ValueType, numa::no_init_allocator<ValueType, AlignedAllocator>>;
+
+// Iterator/Tbb benchmarks run three ways: plain, an aligned container with
+// the plain policy (the control) and the aligned container with the policy
+// that lets the kernels rely on it
+enum class Alignment { none, container, assumed };
+
+static const char* suffix(Alignment a) {
+  switch (a) {
+    case Alignment::none:
+      return "";
+    case Alignment::container:
+      return "AlignedContainer";
+    default:
+      return "Aligned";
+  }
+}
+
+template <Alignment A, typename Policy>
+static auto policyFor(Policy policy) {
+  if constexpr (A == Alignment::assumed) {
+    return pad::exec::assume_aligned(policy);
+  } else {
+    return policy;
+  }
+}
 
 static void Args(benchmark::internal::Benchmark* b) {
   const auto lowerLimit = 15;
@@ -37,6 +81,13 @@ void setCustomCounter(benchmark::State& state, std::string name) {
   state.SetLabel(name);
 }
 
+// Minor page faults of the whole process so far
+static long minorFaults() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
 // Ex 4.1
 struct ValueTypeCast {
   template <typename T>
@@ -45,28 +96,35 @@ struct ValueTypeCast {
   }
 };
 
+// X[i] = i + 1 as the iota views give it, for numa::first_touch
+static ValueType iotaValue(std::size_t i) { return ValueTypeCast{}(i + 1); }
+
+template <Alignment A>
 static void benchReduceIteratorStd(benchmark::State& state) {
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerType,
+                         ContainerTypeAligned>;
   auto iota =
       ranges::views::iota(1) | ranges::views::transform(ValueTypeCast{});
   // Impossible to get NUMA-friendly initialization without a default-init
   // allocator, so this is expected to perform badly
-  ContainerType X(iota.begin(), iota.begin() + state.range(0));
+  Container X(iota.begin(), iota.begin() + state.range(0));
   ValueType sum;
 
   for (auto _ : state) {
-    sum = 0;
-#pragma omp parallel for simd reduction(+ : sum) schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      sum += *x;
-    }
+    sum = pad::reduce(policyFor<A>(pad::exec::omp), X.begin(), X.end());
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorStd");
+  setCustomCounter(state, std::string("IteratorStd") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceIteratorDefaultInit(benchmark::State& state) {
-  ContainerTypeDefaultInit X(state.range(0));
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeDefaultInit,
+                         ContainerTypeDefaultInitAligned>;
+  Container X(state.range(0));
   ValueType sum;
 #pragma omp parallel for simd schedule(static)
   for (auto x = X.begin(); x != X.end(); ++x) {
@@ -74,19 +132,20 @@ static void benchReduceIteratorDefaultInit(benchmark::State& state) {
   }
 
   for (auto _ : state) {
-    sum = 0;
-#pragma omp parallel for simd reduction(+ : sum) schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      sum += *x;
-    }
+    sum = pad::reduce(policyFor<A>(pad::exec::omp), X.begin(), X.end());
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorDefaultInit");
+  setCustomCounter(
+      state, std::string("IteratorDefaultInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceIteratorNoInit(benchmark::State& state) {
-  ContainerTypeNoInit X(state.range(0));
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeNoInit,
+                         ContainerTypeNoInitAligned>;
+  Container X(state.range(0));
   ValueType sum;
   auto iota =
       ranges::views::iota(1) | ranges::views::transform(ValueTypeCast{});
@@ -94,68 +153,61 @@ static void benchReduceIteratorNoInit(benchmark::State& state) {
                             state.range(0), X.begin());
 
   for (auto _ : state) {
-    sum = 0;
-#pragma omp parallel for simd reduction(+ : sum) schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      sum += *x;
-    }
+    sum = pad::reduce(policyFor<A>(pad::exec::omp), X.begin(), X.end());
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorNoInit");
+  setCustomCounter(state, std::string("IteratorNoInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceIteratorNoInit2(benchmark::State& state) {
-  ContainerTypeNoInit X(state.range(0));
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeNoInit,
+                         ContainerTypeNoInitAligned>;
+  Container X(state.range(0));
   ValueType sum;
-#pragma omp parallel for simd schedule(static)
-  for (auto x = X.begin(); x != X.end(); ++x) {
-    new (&*x) ContainerTypeNoInit::value_type{
-        static_cast<ValueType>(x - X.begin() + 1)};
-  }
+  numa::first_touch(X, pad::exec::omp, iotaValue);
 
   for (auto _ : state) {
-    sum = 0;
-#pragma omp parallel for simd reduction(+ : sum) schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      sum += *x;
-    }
+    sum = pad::reduce(policyFor<A>(pad::exec::omp), X.begin(), X.end());
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorNoInit2");
+  setCustomCounter(
+      state, std::string("IteratorNoInit2") + suffix(A));
 }
 
 // Ex 4.2
+template <Alignment A>
 static void benchReduceTbbStd(benchmark::State& state) {
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerType,
+                         ContainerTypeAligned>;
   using namespace oneapi::tbb;
   auto iota =
       ranges::views::iota(1) | ranges::views::transform(ValueTypeCast{});
   // Impossible to get NUMA-friendly initialization without a default-init
   // allocator, so this is expected to perform badly
-  ContainerType X(iota.begin(), iota.begin() + state.range(0));
+  Container X(iota.begin(), iota.begin() + state.range(0));
   static_partitioner part;
 
   for (auto _ : state) {
-    ValueType sum = parallel_reduce(
-        blocked_range<IndexType>(0, X.size()), ValueType{0},
-        [=](blocked_range<IndexType>& r, ValueType acc) {
-#pragma omp simd reduction(+ : acc)
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            acc += X[i];
-          }
-          return acc;
-        },
-        std::plus<ValueType>(), part);
+    ValueType sum = pad::reduce(policyFor<A>(pad::exec::tbb), X.begin(),
+                                X.end(), part);
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbStd");
+  setCustomCounter(state, std::string("TbbStd") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceTbbDefaultInit(benchmark::State& state) {
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeDefaultInit,
+                         ContainerTypeDefaultInitAligned>;
   using namespace oneapi::tbb;
-  ContainerTypeDefaultInit X(state.range(0));
+  Container X(state.range(0));
   static_partitioner part;
   parallel_for(
       blocked_range<IndexType>(0, state.range(0)),
@@ -168,25 +220,21 @@ static void benchReduceTbbDefaultInit(benchmark::State& state) {
       part);
 
   for (auto _ : state) {
-    ValueType sum = parallel_reduce(
-        blocked_range<IndexType>(0, X.size()), ValueType{0},
-        [=](blocked_range<IndexType>& r, ValueType acc) {
-#pragma omp simd reduction(+ : acc)
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            acc += X[i];
-          }
-          return acc;
-        },
-        std::plus<ValueType>(), part);
+    ValueType sum = pad::reduce(policyFor<A>(pad::exec::tbb), X.begin(),
+                                X.end(), part);
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbDefaultInit");
+  setCustomCounter(state, std::string("TbbDefaultInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceTbbNoInit(benchmark::State& state) {
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeNoInit,
+                         ContainerTypeNoInitAligned>;
   using namespace oneapi::tbb;
-  ContainerTypeNoInit X(state.range(0));
+  Container X(state.range(0));
   static_partitioner part;
   auto iota =
       ranges::views::iota(1) | ranges::views::transform(ValueTypeCast{});
@@ -194,60 +242,190 @@ static void benchReduceTbbNoInit(benchmark::State& state) {
                             state.range(0), X.begin());
 
   for (auto _ : state) {
-    ValueType sum = parallel_reduce(
-        blocked_range<IndexType>(0, X.size()), ValueType{0},
-        [=](blocked_range<IndexType>& r, ValueType acc) {
-#pragma omp simd reduction(+ : acc)
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            acc += X[i];
-          }
-          return acc;
-        },
-        std::plus<ValueType>(), part);
+    ValueType sum = pad::reduce(policyFor<A>(pad::exec::tbb), X.begin(),
+                                X.end(), part);
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbNoInit");
+  setCustomCounter(state, std::string("TbbNoInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchReduceTbbNoInit2(benchmark::State& state) {
+  using Container =
+      std::conditional_t<A == Alignment::none, ContainerTypeNoInit,
+                         ContainerTypeNoInitAligned>;
   using namespace oneapi::tbb;
-  ContainerTypeNoInit X(state.range(0));
+  Container X(state.range(0));
   static_partitioner part;
-  parallel_for(
-      blocked_range<IndexType>(0, state.range(0)),
-      [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-        for (auto i = r.begin(); i != r.end(); ++i) {
-          new (&X[i])
-              ContainerTypeNoInit::value_type{static_cast<ValueType>(i + 1)};
-        }
-      },
-      part);
+  numa::first_touch(X, part, iotaValue);
+
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(policyFor<A>(pad::exec::tbb), X.begin(),
+                                X.end(), part);
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbNoInit2") + suffix(A));
+}
+
+// Pages placed by the allocator, then written by the main thread alone, the
+// case first touch gets wrong. next_touch additionally asks for the pages to
+// follow the first TBB thread that reads them. Policies the OS does not apply
+// (next_touch on Linux) are skipped rather than reported as first touch.
+template <numa::membind Policy>
+static void benchReduceTbbMembind(benchmark::State& state) {
+  if (!numa::membind_supported(Policy)) {
+    state.SkipWithError(
+        (std::string(numa::name(Policy)) + " not supported").c_str());
+    return;
+  }
+  ContainerTypeMembind X(state.range(0), MembindAllocator(Policy));
+  oneapi::tbb::static_partitioner part;
+  for (IndexType i = 0; i < state.range(0); ++i) {
+    new (&X[i]) ValueType{ValueTypeCast{}(i + 1)};
+  }
+  if (Policy == numa::membind::next_touch &&
+      !numa::set_membind(X.data(), X.size(), Policy)) {
+    state.SkipWithError("next-touch not supported");
+    return;
+  }
+
+  for (auto _ : state) {
+    ValueType sum = pad::reduce(pad::exec::tbb, X.begin(), X.end(), part);
+    benchmark::DoNotOptimize(&sum);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbMembind-") + numa::name(Policy));
+}
+
+// TbbNoInit2 in pages of the given size. SetupTime (s) and PageFaults cover
+// the allocation and the parallel first touch that faults every page in;
+// bytes_per_second is the steady state after it. Skipped when the kernel
+// maps smaller pages than asked for (empty hugetlb pool, no THP).
+template <numa::huge_pages Mode>
+static void benchReduceTbbHugePages(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  static_partitioner part;
+  const long faults = minorFaults();
+  const auto start = std::chrono::steady_clock::now();
+  ContainerTypeHugePages X(state.range(0), HugePageAllocator(Mode));
+  if (X.get_allocator().granted() != Mode) {
+    state.SkipWithError((std::string(numa::name(Mode)) + " not granted, got " +
+                         numa::name(X.get_allocator().granted()))
+                            .c_str());
+    return;
+  }
+  numa::first_touch(X, part, iotaValue);
+  const std::chrono::duration<double> setup =
+      std::chrono::steady_clock::now() - start;
+  state.counters["SetupTime"] = setup.count();
+  state.counters["PageFaults"] = minorFaults() - faults;
 
   for (auto _ : state) {
-    ValueType sum = parallel_reduce(
-        blocked_range<IndexType>(0, X.size()), ValueType{0},
-        [=](blocked_range<IndexType>& r, ValueType acc) {
-#pragma omp simd reduction(+ : acc)
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            acc += X[i];
-          }
-          return acc;
-        },
-        std::plus<ValueType>(), part);
+    ValueType sum = pad::reduce(pad::exec::tbb, X.begin(), X.end(), part);
     benchmark::DoNotOptimize(&sum);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbNoInit2");
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          sizeof(ValueType));
+  setCustomCounter(state, std::string("TbbHugePages-") + numa::name(Mode));
 }
 
-BENCHMARK(benchReduceIteratorStd)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceIteratorDefaultInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceIteratorNoInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceIteratorNoInit2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceTbbStd)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceTbbDefaultInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceTbbNoInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchReduceTbbNoInit2)->Apply(Args)->UseRealTime();
-BENCHMARK_MAIN();
+BENCHMARK_TEMPLATE(benchReduceIteratorStd, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorStd, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorStd, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorDefaultInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorDefaultInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorDefaultInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceIteratorNoInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbStd, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbStd, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbStd, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbDefaultInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbDefaultInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbDefaultInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbNoInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbMembind, numa::membind::bind)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbMembind, numa::membind::interleave)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbMembind, numa::membind::first_touch)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbMembind, numa::membind::next_touch)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbHugePages, numa::huge_pages::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbHugePages, numa::huge_pages::transparent)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbHugePages, numa::huge_pages::hugetlb_2m)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceTbbHugePages, numa::huge_pages::hugetlb_1g)
+    ->Apply(Args)
+    ->UseRealTime();
+PAD_BENCHMARK_MAIN();
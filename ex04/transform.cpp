@@ -1,6 +1,7 @@
 #include <benchmark/benchmark.h>  // google benchmark
 #include <umesimd/UMESimd.h>
 #include <algorithm>
+#include <chrono>
 #include <execution>
 #include <numeric>
 #include <iostream>
@@ -8,16 +9,54 @@
 #include <utility>
 #include <vector>
 #include <array>
+#include <sys/resource.h>
 #include "range/v3/view.hpp"
 #include "omp.h"
 #include "oneapi/tbb.h"
-#include "allocator_adaptor.hpp"
+#include "pad/allocator.hpp"
+#include "pad/first_touch.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using IndexType = ssize_t;
 using ValueType = float;
 using ContainerType = std::vector<ValueType>;
 using ContainerTypeDefaultInit = std::vector<ValueType, numa::default_init_allocator<ValueType>>;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
+using MembindAllocator = numa::no_init_allocator<ValueType, numa::membind_allocator<ValueType>>;
+using ContainerTypeMembind = std::vector<ValueType, MembindAllocator>;
+using HugePageAllocator = numa::no_init_allocator<ValueType, numa::huge_page_allocator<ValueType>>;
+using ContainerTypeHugePages = std::vector<ValueType, HugePageAllocator>;
+
+// The same containers with their first element on a cache line
+using ContainerTypeAligned = std::vector<ValueType, numa::aligned_allocator<ValueType>>;
+using ContainerTypeDefaultInitAligned = std::vector<ValueType, numa::default_init_allocator<ValueType, numa::aligned_allocator<ValueType>>>;
+using ContainerTypeNoInitAligned = std::vector<ValueType, numa::no_init_allocator<ValueType, numa::aligned_allocator<ValueType>>>;
+
+// Iterator/Tbb benchmarks run three ways: plain, an aligned container with
+// the plain policy (the control) and the aligned container with the policy
+// that lets the kernels rely on it
+enum class Alignment { none, container, assumed };
+
+static const char* suffix(Alignment a) {
+  switch (a) {
+    case Alignment::none:
+      return "";
+    case Alignment::container:
+      return "AlignedContainer";
+    default:
+      return "Aligned";
+  }
+}
+
+template <Alignment A, typename Policy>
+static auto policyFor(Policy policy) {
+  if constexpr (A == Alignment::assumed) {
+    return pad::exec::assume_aligned(policy);
+  } else {
+    return policy;
+  }
+}
 
 static void Args(benchmark::internal::Benchmark* b) {
   const auto lowerLimit = 15;
@@ -31,69 +70,71 @@ static void Args(benchmark::internal::Benchmark* b) {
 void setCustomCounter(benchmark::State& state, std::string name) {
   state.counters["Elements"] = state.range(0);
   state.counters["Bytes"] = 3 * state.range(0) * sizeof(ValueType);
+  state.SetBytesProcessed(state.iterations() * 3 * state.range(0) *
+                          sizeof(ValueType));
   state.SetLabel(name);
 }
 
+// Minor page faults of the whole process so far
+static long minorFaults() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
 // Ex 4.1
+template <Alignment A>
 static void benchTransformIteratorStd(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeAligned, ContainerType>;
   ValueType a = -1;
-  ContainerType X(state.range(0), 1);
-  ContainerType Y(state.range(0), 2);
+  Container X(state.range(0), 1);
+  Container Y(state.range(0), 2);
   
   for (auto _ : state) {
-    auto y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorStd");
+  setCustomCounter(state, std::string("IteratorStd") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformIteratorStd2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeAligned, ContainerType>;
   ValueType a = -1;
-  ContainerType X;
-  ContainerType Y;
+  Container X;
+  Container Y;
   X.resize(state.range(0), 1);
   Y.resize(state.range(0), 2);
   
   for (auto _ : state) {
-    auto y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorStd2");
+  setCustomCounter(state, std::string("IteratorStd2") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformIteratorDefaultInit(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeDefaultInitAligned, ContainerTypeDefaultInit>;
   ValueType a = -1;
-  ContainerTypeDefaultInit X(state.range(0));
-  ContainerTypeDefaultInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   std::fill(std::execution::par_unseq, X.begin(), X.end(), 1);
   std::fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);
 
   for (auto _ : state) {
-    auto y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorDefaultInit");
+  setCustomCounter(state, std::string("IteratorDefaultInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformIteratorDefaultInit2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeDefaultInitAligned, ContainerTypeDefaultInit>;
   ValueType a = -1;
-  ContainerTypeDefaultInit X(state.range(0));
-  ContainerTypeDefaultInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   auto y = Y.begin();
 #pragma omp parallel for simd schedule(static)
   for (auto x = X.begin(); x != X.end(); ++x) {
@@ -103,137 +144,105 @@ static void benchTransformIteratorDefaultInit2(benchmark::State& state) {
   }
 
   for (auto _ : state) {
-    y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorDefaultInit2");
+  setCustomCounter(state, std::string("IteratorDefaultInit2") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformIteratorNoInit(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeNoInitAligned, ContainerTypeNoInit>;
   ValueType a = -1;
-  ContainerTypeNoInit X(state.range(0));
-  ContainerTypeNoInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   std::uninitialized_fill(std::execution::par_unseq, X.begin(), X.end(), 1);
   std::uninitialized_fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);
 
   for (auto _ : state) {
-    auto y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorNoInit");
+  setCustomCounter(state, std::string("IteratorNoInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformIteratorNoInit2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeNoInitAligned, ContainerTypeNoInit>;
   ValueType a = -1;
-  ContainerTypeNoInit X(state.range(0));
-  ContainerTypeNoInit Y(state.range(0));
-  auto y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-  for (auto x = X.begin(); x != X.end(); ++x) {
-    new(&*x) ContainerTypeNoInit::value_type{1};
-    new(&*y) ContainerTypeNoInit::value_type{2};
-    ++y;
-  }
+  Container X(state.range(0));
+  Container Y(state.range(0));
+  numa::first_touch(X, pad::exec::omp, ValueType{1});
+  numa::first_touch(Y, pad::exec::omp, ValueType{2});
 
   for (auto _ : state) {
-    y = Y.begin();
-#pragma omp parallel for simd schedule(static)
-    for (auto x = X.begin(); x != X.end(); ++x) {
-      *y = a * (*x) + *y;
-      ++y;
-    }
+    pad::transform(policyFor<A>(pad::exec::omp), a, X.begin(), X.end(), Y.begin());
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "IteratorNoInit2");
+  setCustomCounter(state, std::string("IteratorNoInit2") + suffix(A));
 }
 
 
 // Ex 4.2
+template <Alignment A>
 static void benchTransformTbbStd(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeAligned, ContainerType>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerType X(state.range(0), 1);
-  ContainerType Y(state.range(0), 2);
+  Container X(state.range(0), 1);
+  Container Y(state.range(0), 2);
   static_partitioner part;
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbStd");
+  setCustomCounter(state, std::string("TbbStd") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformTbbStd2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeAligned, ContainerType>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerType X;
-  ContainerType Y;
+  Container X;
+  Container Y;
   static_partitioner part;
   X.resize(state.range(0), 1);
   Y.resize(state.range(0), 2);
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbStd2");
+  setCustomCounter(state, std::string("TbbStd2") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformTbbDefaultInit(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeDefaultInitAligned, ContainerTypeDefaultInit>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerTypeDefaultInit X(state.range(0));
-  ContainerTypeDefaultInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   static_partitioner part;
   std::fill(std::execution::par_unseq, X.begin(), X.end(), 1);
   std::fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);  
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbDefaultInit");
+  setCustomCounter(state, std::string("TbbDefaultInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformTbbDefaultInit2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeDefaultInitAligned, ContainerTypeDefaultInit>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerTypeDefaultInit X(state.range(0));
-  ContainerTypeDefaultInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   static_partitioner part;
     parallel_for(
         blocked_range<IndexType>(0, state.range(0)),
@@ -247,87 +256,303 @@ static void benchTransformTbbDefaultInit2(benchmark::State& state) {
         part);  
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbDefaultInit2");
+  setCustomCounter(state, std::string("TbbDefaultInit2") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformTbbNoInit(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeNoInitAligned, ContainerTypeNoInit>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerTypeNoInit X(state.range(0));
-  ContainerTypeNoInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   static_partitioner part;
   std::uninitialized_fill(std::execution::par_unseq, X.begin(), X.end(), 1);
   std::uninitialized_fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbNoInit");
+  setCustomCounter(state, std::string("TbbNoInit") + suffix(A));
 }
 
+template <Alignment A>
 static void benchTransformTbbNoInit2(benchmark::State& state) {
+  using Container = std::conditional_t<A != Alignment::none, ContainerTypeNoInitAligned, ContainerTypeNoInit>;
   using namespace oneapi::tbb;
   ValueType a = -1;
-  ContainerTypeNoInit X(state.range(0));
-  ContainerTypeNoInit Y(state.range(0));
+  Container X(state.range(0));
+  Container Y(state.range(0));
   static_partitioner part;
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            new(&X[i]) ContainerTypeNoInit::value_type{1};
-            new(&Y[i]) ContainerTypeNoInit::value_type{2};
-          }
-        },
-        part);  
+  numa::first_touch(X, part, ValueType{1});
+  numa::first_touch(Y, part, ValueType{2});
   
   for (auto _ : state) {
-    parallel_for(
-        blocked_range<IndexType>(0, state.range(0)),
-        [&](const blocked_range<IndexType>& r) {
-#pragma omp simd
-          for (auto i = r.begin(); i != r.end(); ++i) {
-            Y[i] = a * X[i] + Y[i];
-          }
-        },
-        part);
+    pad::transform(policyFor<A>(pad::exec::tbb), a, X.begin(), X.end(), Y.begin(), part);
     benchmark::ClobberMemory();
   }
-  setCustomCounter(state, "TbbNoInit2");
+  setCustomCounter(state, std::string("TbbNoInit2") + suffix(A));
 }
 
+// TbbNoInit with the given store hint; non_temporal writes Y with
+// streaming stores
+template <pad::exec::store_hint Hint>
+static void benchTransformTbbNoInitStores(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerTypeNoInit X(state.range(0));
+  ContainerTypeNoInit Y(state.range(0));
+  oneapi::tbb::static_partitioner part;
+  std::uninitialized_fill(std::execution::par_unseq, X.begin(), X.end(), 1);
+  std::uninitialized_fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);
+  const auto policy = pad::exec::stores(pad::exec::tbb, Hint);
+
+  for (auto _ : state) {
+    pad::transform(policy, a, X.begin(), X.end(), Y.begin(), part);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbNoInit-") + pad::exec::name(Hint));
+}
+
+// Out of place, Z = a * X + Y: no line of Z is read before it is written, so
+// streaming stores save the read-for-ownership
+template <pad::exec::store_hint Hint>
+static void benchTransformToTbbNoInit(benchmark::State& state) {
+  ValueType a = -1;
+  ContainerTypeNoInit X(state.range(0));
+  ContainerTypeNoInit Y(state.range(0));
+  ContainerTypeNoInit Z(state.range(0));
+  oneapi::tbb::static_partitioner part;
+  std::uninitialized_fill(std::execution::par_unseq, X.begin(), X.end(), 1);
+  std::uninitialized_fill(std::execution::par_unseq, Y.begin(), Y.end(), 2);
+  std::uninitialized_fill(std::execution::par_unseq, Z.begin(), Z.end(), 0);
+  const auto policy = pad::exec::stores(pad::exec::tbb, Hint);
+
+  for (auto _ : state) {
+    pad::transform_to(policy, a, X.begin(), X.end(), Y.begin(), Z.begin(),
+                      part);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbToNoInit-") + pad::exec::name(Hint));
+}
+
+// X and Y placed by the allocator and written by the main thread alone;
+// see benchReduceTbbMembind in reduction.cpp
+template <numa::membind Policy>
+static void benchTransformTbbMembind(benchmark::State& state) {
+  if (!numa::membind_supported(Policy)) {
+    state.SkipWithError(
+        (std::string(numa::name(Policy)) + " not supported").c_str());
+    return;
+  }
+  ValueType a = -1;
+  ContainerTypeMembind X(state.range(0), MembindAllocator(Policy));
+  ContainerTypeMembind Y(state.range(0), MembindAllocator(Policy));
+  oneapi::tbb::static_partitioner part;
+  std::uninitialized_fill(X.begin(), X.end(), 1);
+  std::uninitialized_fill(Y.begin(), Y.end(), 2);
+  if (Policy == numa::membind::next_touch &&
+      !(numa::set_membind(X.data(), X.size(), Policy) &&
+        numa::set_membind(Y.data(), Y.size(), Policy))) {
+    state.SkipWithError("next-touch not supported");
+    return;
+  }
+
+  for (auto _ : state) {
+    pad::transform(pad::exec::tbb, a, X.begin(), X.end(), Y.begin(), part);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbMembind-") + numa::name(Policy));
+}
+
+// TbbNoInit2 in pages of the given size; SetupTime (s) and PageFaults cover
+// mapping X and Y and faulting them in, see benchReduceTbbHugePages
+template <numa::huge_pages Mode>
+static void benchTransformTbbHugePages(benchmark::State& state) {
+  using namespace oneapi::tbb;
+  ValueType a = -1;
+  static_partitioner part;
+  const long faults = minorFaults();
+  const auto start = std::chrono::steady_clock::now();
+  ContainerTypeHugePages X(state.range(0), HugePageAllocator(Mode));
+  ContainerTypeHugePages Y(state.range(0), HugePageAllocator(Mode));
+  for (const auto& Z : {&X, &Y}) {
+    if (Z->get_allocator().granted() != Mode) {
+      state.SkipWithError((std::string(numa::name(Mode)) + " not granted, got " +
+                           numa::name(Z->get_allocator().granted()))
+                              .c_str());
+      return;
+    }
+  }
+  numa::first_touch(X, part, ValueType{1});
+  numa::first_touch(Y, part, ValueType{2});
+  const std::chrono::duration<double> setup =
+      std::chrono::steady_clock::now() - start;
+  state.counters["SetupTime"] = setup.count();
+  state.counters["PageFaults"] = minorFaults() - faults;
+
+  for (auto _ : state) {
+    pad::transform(pad::exec::tbb, a, X.begin(), X.end(), Y.begin(), part);
+    benchmark::ClobberMemory();
+  }
+  setCustomCounter(state, std::string("TbbHugePages-") + numa::name(Mode));
+}
 
-BENCHMARK(benchTransformIteratorStd)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformIteratorStd2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformIteratorDefaultInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformIteratorDefaultInit2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformIteratorNoInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformIteratorNoInit2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbStd)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbStd2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbDefaultInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbDefaultInit2)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbNoInit)->Apply(Args)->UseRealTime();
-BENCHMARK(benchTransformTbbNoInit2)->Apply(Args)->UseRealTime();
-BENCHMARK_MAIN();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorStd2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorDefaultInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformIteratorNoInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbStd2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbDefaultInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit2, Alignment::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit2, Alignment::container)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInit2, Alignment::assumed)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStores,
+                   pad::exec::store_hint::temporal)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStores,
+                   pad::exec::store_hint::non_temporal)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStores,
+                   pad::exec::store_hint::automatic)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformToTbbNoInit, pad::exec::store_hint::temporal)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformToTbbNoInit,
+                   pad::exec::store_hint::non_temporal)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformToTbbNoInit, pad::exec::store_hint::automatic)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbMembind, numa::membind::bind)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbMembind, numa::membind::interleave)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbMembind, numa::membind::first_touch)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbMembind, numa::membind::next_touch)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbHugePages, numa::huge_pages::none)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbHugePages, numa::huge_pages::transparent)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbHugePages, numa::huge_pages::hugetlb_2m)
+    ->Apply(Args)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformTbbHugePages, numa::huge_pages::hugetlb_1g)
+    ->Apply(Args)
+    ->UseRealTime();
+PAD_BENCHMARK_MAIN();
@@ -1,8 +1,11 @@
+#pragma once
+
 #include <hwloc.h>
 #include <tuple>
 #include <vector>
 #include <unistd.h>
 #include <cstdlib>
+#include <omp.h>
 #include <oneapi/tbb/task_arena.h>
 #include "allocator_adaptor.hpp"
 
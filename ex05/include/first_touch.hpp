@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <omp.h>
+
+#include "pad/first_touch.hpp"
+#include "arena.hpp"
+
+namespace numa {
+// The arenas of an ArenaMgtTBB: node k's index_range share from its arena,
+// split by `part` as the kernel called on that share in that arena splits it
+// (grain_size in elements, see the tbb overload in pad/first_touch.hpp)
+template <typename Container, typename Partitioner, typename Generator>
+void first_touch(Container& c,
+                 ArenaMgtTBB& arenas,
+                 Partitioner& part,
+                 Generator gen,
+                 std::size_t grain_size = 1) {
+  auto* p = c.data();
+  const std::size_t n = c.size();
+#pragma omp parallel num_threads(arenas.get_size())
+  {
+    const int mth = omp_get_thread_num();
+    auto [start, end] = arenas.index_range(mth, n);
+    const std::size_t s = start;
+    const std::size_t e = end;
+    arenas[mth]->execute(
+        [&] { detail::touch_tbb(p, s, e - s, part, grain_size, gen); });
+  }
+}
+}  // namespace numa
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sys/mman.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+#include "arena.hpp"
+
+namespace numa {
+
+// Hits and misses count slabs: a hit is a slab taken from a free list, a miss
+// one that had to be faulted in first. resident_bytes[node] is what the pool
+// holds on that node, handed out or free.
+struct pool_stats {
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+  std::vector<std::size_t> resident_bytes;
+  std::vector<std::size_t> free_bytes;
+
+  double hit_rate() const {
+    return hits + misses == 0 ? 0.0 : double(hits) / double(hits + misses);
+  }
+};
+
+// Per-NUMA-node free lists of pre-faulted slabs of slab_bytes each. Every
+// slab is written once by a thread of the arena of its node, so its pages
+// are resident and local before any container sees them.
+//
+// allocate(bytes) reserves one contiguous address range and moves slabs into
+// it with mremap, without faulting: the share of the range that
+// ArenaMgtTBB::index_range gives node k comes from node k's list (to the
+// nearest slab). Slabs a list lacks are faulted in outside the lock, and
+// if allocate throws every slab it took goes back. deallocate puts the slabs
+// back where they came from. The arenas must outlive the pool.
+class node_pool {
+ public:
+  node_pool(ArenaMgtTBB& arenas,
+            std::size_t bytes_per_node,
+            std::size_t slab_bytes = std::size_t{1} << 21)
+      : arenas_(arenas), slab_(slab_bytes), free_(arenas.get_size()) {
+    stats_.resident_bytes.assign(arenas.get_size(), 0);
+    stats_.free_bytes.assign(arenas.get_size(), 0);
+    for (int node = 0; node < arenas.get_size(); ++node) {
+      populate(node, (bytes_per_node + slab_ - 1) / slab_);
+    }
+  }
+
+  ~node_pool() {
+    for (auto& list : free_) {
+      for (void* slab : list) munmap(slab, slab_);
+    }
+  }
+
+  node_pool(const node_pool&) = delete;
+  node_pool& operator=(const node_pool&) = delete;
+
+  void* allocate(std::size_t bytes) {
+    const std::size_t slabs = slab_count(bytes);
+    const std::size_t nodes = free_.size();
+    void* range = mmap(nullptr, slabs * slab_, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (range == MAP_FAILED) throw std::bad_alloc();
+    auto* base = static_cast<char*>(range);
+
+    std::vector<std::size_t> need(nodes, 0);
+    for (std::size_t i = 0; i < slabs; ++i) ++need[node_of(i, slabs)];
+    std::vector<std::vector<void*>> taken(nodes);
+    std::size_t moved = 0;
+    try {
+      for (std::size_t node = 0; node < nodes; ++node) {
+        taken[node].reserve(need[node]);
+      }
+      // Slabs from the free lists first; the misses are faulted in without
+      // holding mutex_, so other allocations go on meanwhile
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t node = 0; node < nodes; ++node) {
+          auto& list = free_[node];
+          const std::size_t n = std::min(need[node], list.size());
+          taken[node].assign(list.end() - n, list.end());
+          list.resize(list.size() - n);
+          stats_.hits += n;
+          stats_.free_bytes[node] -= n * slab_;
+        }
+      }
+      for (std::size_t node = 0; node < nodes; ++node) {
+        const std::size_t missing = need[node] - taken[node].size();
+        if (missing == 0) continue;
+        char* chunk = fault_in(node, missing);
+        for (std::size_t s = 0; s < missing; ++s) {
+          taken[node].push_back(chunk + s * slab_);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.misses += missing;
+        stats_.resident_bytes[node] += missing * slab_;
+      }
+      for (; moved < slabs; ++moved) {
+        auto& list = taken[node_of(moved, slabs)];
+        if (mremap(list.back(), slab_, slab_, MREMAP_MAYMOVE | MREMAP_FIXED,
+                   base + moved * slab_) == MAP_FAILED) {
+          throw std::bad_alloc();
+        }
+        list.pop_back();
+      }
+    } catch (...) {
+      // Every slab taken goes back to its list, the ones already moved at
+      // their address in the block, and the rest of the block is unmapped
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < moved; ++i) {
+          const int node = node_of(i, slabs);
+          free_[node].push_back(base + i * slab_);
+          stats_.free_bytes[node] += slab_;
+        }
+        for (std::size_t node = 0; node < nodes; ++node) {
+          free_[node].insert(free_[node].end(), taken[node].begin(),
+                             taken[node].end());
+          stats_.free_bytes[node] += taken[node].size() * slab_;
+        }
+      }
+      munmap(base + moved * slab_, (slabs - moved) * slab_);
+      throw;
+    }
+    return range;
+  }
+
+  // Returns the slabs of a block from allocate(bytes) to their lists. They
+  // keep their pages, and their addresses inside the old block.
+  void deallocate(void* p, std::size_t bytes) noexcept {
+    const std::size_t slabs = slab_count(bytes);
+    auto* base = static_cast<char*>(p);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < slabs; ++i) {
+      const int node = node_of(i, slabs);
+      free_[node].push_back(base + i * slab_);
+      stats_.free_bytes[node] += slab_;
+    }
+  }
+
+  pool_stats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  void reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.hits = 0;
+    stats_.misses = 0;
+  }
+
+  std::size_t slab_bytes() const { return slab_; }
+
+ private:
+  std::size_t slab_count(std::size_t bytes) const {
+    return bytes == 0 ? 1 : (bytes + slab_ - 1) / slab_;
+  }
+
+  // Node whose index_range share holds the middle of slab i of `slabs`
+  int node_of(std::size_t i, std::size_t slabs) const {
+    const std::size_t nodes = arenas_.get_size();
+    const std::size_t total = slabs * slab_;
+    const std::size_t part = total / nodes;
+    const std::size_t rest = total % nodes;
+    const std::size_t mid = i * slab_ + slab_ / 2;
+    if (mid < part + rest || part == 0) return 0;
+    return static_cast<int>(std::min((mid - rest) / part, nodes - 1));
+  }
+
+  // Maps `count` slabs in one go and faults them in from the arena of
+  // `node`, one write per 4 KiB page. Takes no lock.
+  char* fault_in(int node, std::size_t count) {
+    void* chunk = mmap(nullptr, count * slab_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (chunk == MAP_FAILED) throw std::bad_alloc();
+    auto* bytes = static_cast<char*>(chunk);
+    const std::size_t pages = count * slab_ / 4096;
+    arenas_[node]->execute([&] {
+      tbb::parallel_for(
+          tbb::blocked_range<std::size_t>(0, pages),
+          [&](const tbb::blocked_range<std::size_t>& r) {
+            for (auto page = r.begin(); page != r.end(); ++page) {
+              bytes[page * 4096] = 0;
+            }
+          },
+          tbb::static_partitioner{});
+    });
+    return bytes;
+  }
+
+  // Initial fill of `node`'s free list with `count` slabs
+  void populate(int node, std::size_t count) {
+    if (count == 0) return;
+    char* chunk = fault_in(node, count);
+    for (std::size_t s = 0; s < count; ++s) {
+      free_[node].push_back(chunk + s * slab_);
+    }
+    stats_.resident_bytes[node] += count * slab_;
+    stats_.free_bytes[node] += count * slab_;
+  }
+
+  ArenaMgtTBB& arenas_;
+  const std::size_t slab_;
+  std::vector<std::vector<void*>> free_;
+  pool_stats stats_;
+  mutable std::mutex mutex_;
+};
+
+// Allocator on a node_pool:
+//   numa::node_pool pool(arenas, bytes_per_node);
+//   using A = no_init_allocator<T, pool_allocator<T>>;
+//   std::vector<T, A> X(n, A(pool));
+// Containers land on pages that are already resident on the node of the
+// arena whose index_range covers them. Allocators of the same pool are equal.
+template <typename T>
+class pool_allocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+
+  explicit pool_allocator(node_pool& pool) noexcept : pool_(&pool) {}
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U>& other) noexcept
+      : pool_(&other.pool()) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    pool_->deallocate(p, n * sizeof(T));
+  }
+
+  node_pool& pool() const noexcept { return *pool_; }
+
+ private:
+  node_pool* pool_;
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T>& a, const pool_allocator<U>& b) {
+  return &a.pool() == &b.pool();
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T>& a, const pool_allocator<U>& b) {
+  return !(a == b);
+}
+
+// Arenas and a pool of `bytes` split evenly over the nodes, for benchmarks
+// that share one pool across every size of a sweep:
+//   static numa::pool_fixture fixture(threads_per_node, bytes);
+//   auto& [arenas, pool] = fixture;
+struct pool_fixture {
+  ArenaMgtTBB arenas;
+  node_pool pool;
+
+  pool_fixture(int threads_per_node, std::size_t bytes)
+      : arenas(threads_per_node), pool(arenas, bytes / arenas.get_size()) {}
+};
+
+// Benchmark counters of a pool run on a benchmark::State: SetupTime (s) of
+// allocating and initializing the containers, the share of slabs the pool
+// had ready and what it keeps resident per node (MiB)
+template <typename State>
+void set_pool_counters(State& state, const node_pool& pool, double setup) {
+  const pool_stats stats = pool.stats();
+  state.counters["SetupTime"] = setup;
+  state.counters["PoolHitRate"] = stats.hit_rate();
+  for (std::size_t node = 0; node < stats.resident_bytes.size(); ++node) {
+    state.counters["ResidentMiB" + std::to_string(node)] =
+        stats.resident_bytes[node] >> 20;
+  }
+}
+
+}  // namespace numa
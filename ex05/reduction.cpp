@@ -14,6 +14,8 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "allocator_adaptor.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
@@ -62,13 +64,7 @@ static void benchReduceTbbNoInit(benchmark::State& state){
                     tbb::task_arena numa_arena{thrds_per_node};
                     numa::PinningObserver p{numa_arena, topo, i, thrds_per_node};
                     numa_arena.execute([&](){
-                        auto sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size), 0,
-                                                        [&](const tbb::blocked_range<size_t> r, ValueType ret){
-                                                            for (size_t j = r.begin(); j < r.end(); j++){
-                                                                ret += X[i * size + j];
-                                                            }
-                                                            return ret;
-                                                        }, std::plus<ValueType>(), part);
+                        auto sum = pad::reduce(pad::exec::tbb, X.begin() + i * size, X.begin() + (i + 1) * size, part);
                         partSumPromise[i].set_value(sum);
                     });
                 }
@@ -136,13 +132,7 @@ static void benchReduceTbbNoInit2(benchmark::State& state){
                     tbb::task_arena numa_arena{thrds_per_node};
                     numa::PinningObserver p{numa_arena, topo, i, thrds_per_node};
                     numa_arena.execute([&](){
-                        auto sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size), 0,
-                                                        [&](const tbb::blocked_range<size_t> r, ValueType ret){
-                                                            for (size_t j = r.begin(); j < r.end(); j++){
-                                                                ret += X[i * size + j];
-                                                            }
-                                                            return ret;
-                                                        }, std::plus<ValueType>(), part);
+                        auto sum = pad::reduce(pad::exec::tbb, X.begin() + i * size, X.begin() + (i + 1) * size, part);
                         partSumPromise[i].set_value(sum);
                     });
                 }
@@ -163,4 +153,4 @@ static void benchReduceTbbNoInit2(benchmark::State& state){
 
 BENCHMARK(benchReduceTbbNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceTbbNoInit2)->Apply(Args)->UseRealTime();
-BENCHMARK_MAIN();
\ No newline at end of file
+PAD_BENCHMARK_MAIN();
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "allocator_adaptor.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
@@ -75,14 +77,7 @@ static void benchReduceTbbNoInitV2(benchmark::State& state){
         #pragma omp parallel for
         for(int i = 0; i < num_nodes; i++){
             part_sums[i] = numa_arenas[i].execute([&, i]() -> ValueType {
-                ValueType sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size), 0,
-                                                [&](const tbb::blocked_range<size_t> r, ValueType ret) -> ValueType {
-						    for (size_t j = r.begin(); j < r.end(); j++){
-                                                        ret += X[i * size + j];
-                                                    }
-                                                    return ret;
-                                                }, std::plus<ValueType>(), part);
-                return sum;
+                return pad::reduce(pad::exec::tbb, X.begin() + i * size, X.begin() + (i + 1) * size, part);
             });
 
         }
@@ -125,14 +120,7 @@ static void benchReduceTbbNoInit2V2(benchmark::State& state){
         #pragma omp parallel for
         for(int i = 0; i < num_nodes; i++){
             part_sums[i] = numa_arenas[i].execute([&, i]() -> ValueType {
-                ValueType sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size), 0,
-                                                [&](const tbb::blocked_range<size_t> r, ValueType ret) -> ValueType {
-                                                    for (size_t j = r.begin(); j < r.end(); j++){
-                                                        ret += X[i * size + j];
-                                                    }
-                                                    return ret;
-                                                }, std::plus<ValueType>(), part);
-                return sum;
+                return pad::reduce(pad::exec::tbb, X.begin() + i * size, X.begin() + (i + 1) * size, part);
             });
         }
         for(auto sums : part_sums) total_sum += sums;     
@@ -147,4 +135,4 @@ static void benchReduceTbbNoInit2V2(benchmark::State& state){
 
 BENCHMARK(benchReduceTbbNoInitV2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceTbbNoInit2V2)->Apply(Args)->UseRealTime();
-BENCHMARK_MAIN();
+PAD_BENCHMARK_MAIN();
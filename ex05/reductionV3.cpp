@@ -1,8 +1,11 @@
 #include <vector>
+#include <chrono>
+#include <string>
 #include <algorithm>
 #include <thread>
 #include <future>
 #include <hwloc.h>
+#include <sys/resource.h>
 #include <iostream>
 #include <execution>
 #include <omp.h>
@@ -15,9 +18,17 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "arena.hpp"
+#include "first_touch.hpp"
+#include "pool_allocator.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
+using HugePageAllocator = numa::no_init_allocator<ValueType, numa::huge_page_allocator<ValueType>>;
+using ContainerTypeHugePages = std::vector<ValueType, HugePageAllocator>;
+using PoolAllocator = numa::no_init_allocator<ValueType, numa::pool_allocator<ValueType>>;
+using ContainerTypePool = std::vector<ValueType, PoolAllocator>;
 using Partitioner = tbb::static_partitioner;
 
 static constexpr int thrds_per_node = 16;
@@ -62,15 +73,7 @@ static void benchReduceTbbNoInitV3(benchmark::State& state){
             auto s = start;                                         // icp won't let us capture structural bindings directly
 	        auto e = end;
 	        part_sum = arenas[mth]->execute([&]() -> ValueType {
-                ValueType sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(s, e), 0,
-                                                [&](const tbb::blocked_range<size_t> r, ValueType ret) -> ValueType {
-                                                    #pragma omp simd reduction(+ : ret)
-                                                    for (size_t i = r.begin(); i < r.end(); i++){
-                                                        ret += X[i];
-                                                    }
-                                                    return ret;
-                                                }, std::plus<ValueType>(), part);
-                return sum;
+                return pad::reduce(pad::exec::tbb, X.begin() + s, X.begin() + e, part);
             });
             total_sum += part_sum;
         }
@@ -88,20 +91,7 @@ static void benchReduceTbbNoInit2V3(benchmark::State& state){
     ContainerTypeNoInit X(state.range(0));
     Partitioner part;
 
-    #pragma omp parallel
-    {
-        auto mth = omp_get_thread_num();
-        auto [start, end] = arenas.index_range(mth, X.size());
-        auto s = start;
-        auto e = end;
-        arenas[mth]->execute([&](){
-            tbb::parallel_for(tbb::blocked_range<size_t>(s, e), [&](const tbb::blocked_range<size_t> r){
-                for(size_t i = r.begin(); i < r.end(); i++){
-                    new(&X[i]) ContainerTypeNoInit::value_type{1};
-                }
-            }, part);                 
-        });
-    }
+    numa::first_touch(X, arenas, part, ValueType{1});
 
     ValueType part_sum;
     std::atomic<ValueType> total_sum;
@@ -114,15 +104,7 @@ static void benchReduceTbbNoInit2V3(benchmark::State& state){
             auto s = start;                                         // icp won't let us capture structural bindings directly
             auto e = end;
             part_sum = arenas[mth]->execute([&]() -> ValueType {
-                ValueType sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(s, e), 0,
-                                                [&](const tbb::blocked_range<size_t> r, ValueType ret) -> ValueType {
-                                                    #pragma omp simd reduction(+ : ret)
-                                                    for (size_t i = r.begin(); i < r.end(); i++){
-                                                        ret += X[i];
-                                                    }
-                                                    return ret;
-                                                }, std::plus<ValueType>(), part);
-                return sum;
+                return pad::reduce(pad::exec::tbb, X.begin() + s, X.begin() + e, part);
             });
             total_sum += part_sum;
         }  
@@ -134,6 +116,136 @@ static void benchReduceTbbNoInit2V3(benchmark::State& state){
     setCustomCounter(state, "ReduceTbbNoInit2V3");
 }
 
+// pad's per-node arenas, first touched with the same split as they reduce
+// with. The plain path adds the node sums in arrival order; the
+// deterministic one sums fixed blocks in a fixed tree.
+template <bool Deterministic>
+static void benchReduceNumaV3(benchmark::State& state){
+    ContainerTypeNoInit X(state.range(0));
+    pad::numa::for_each_node(X.size(), [&](int, pad::index_type b, pad::index_type e) {
+        std::uninitialized_fill(X.begin() + b, X.begin() + e, 1);
+    });
+
+    ValueType sum;
+    for (auto _ : state){
+        if constexpr (Deterministic) {
+            sum = pad::reduce(pad::exec::deterministic(pad::exec::numa), X.begin(), X.end());
+        } else {
+            sum = pad::reduce(pad::exec::numa, X.begin(), X.end());
+        }
+        benchmark::DoNotOptimize(&sum);
+        benchmark::ClobberMemory();
+    }
+    if (sum != static_cast<ValueType>(state.range(0))) std::cout << "wrong result" << std::endl;
+    setCustomCounter(state, Deterministic ? "ReduceNumaDeterministicV3" : "ReduceNumaV3");
+}
+
+// The same node split with a compensated, pairwise or double-accumulated
+// sum; unlike the plain float sum these still hit range(0) past 2^24.
+template <pad::exec::summation Method>
+static void benchReduceNumaAccurateV3(benchmark::State& state){
+    ContainerTypeNoInit X(state.range(0));
+    pad::numa::for_each_node(X.size(), [&](int, pad::index_type b, pad::index_type e) {
+        std::uninitialized_fill(X.begin() + b, X.begin() + e, 1);
+    });
+
+    const auto policy = pad::exec::accurate(pad::exec::numa, Method);
+    ValueType sum;
+    for (auto _ : state){
+        sum = pad::reduce(policy, X.begin(), X.end());
+        benchmark::DoNotOptimize(&sum);
+        benchmark::ClobberMemory();
+    }
+    if (sum != static_cast<ValueType>(state.range(0))) std::cout << "wrong result" << std::endl;
+    setCustomCounter(state, std::string("ReduceNumaAccurateV3-") + pad::exec::name(Method));
+}
+
+// benchReduceNumaV3 in pages of the given size, still placed by per-node
+// first touch. SetupTime (s) and PageFaults cover mapping and faulting X in.
+// Skipped when the kernel maps smaller pages than asked for.
+template <numa::huge_pages Mode>
+static void benchReduceNumaHugePagesV3(benchmark::State& state){
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const long faults = usage.ru_minflt;
+    const auto start = std::chrono::steady_clock::now();
+    ContainerTypeHugePages X(state.range(0), HugePageAllocator(Mode));
+    if (X.get_allocator().granted() != Mode){
+        state.SkipWithError((std::string(numa::name(Mode)) + " not granted, got "
+                             + numa::name(X.get_allocator().granted())).c_str());
+        return;
+    }
+    pad::numa::for_each_node(X.size(), [&](int, pad::index_type b, pad::index_type e) {
+        std::uninitialized_fill(X.begin() + b, X.begin() + e, 1);
+    });
+    const std::chrono::duration<double> setup = std::chrono::steady_clock::now() - start;
+    getrusage(RUSAGE_SELF, &usage);
+    state.counters["SetupTime"] = setup.count();
+    state.counters["PageFaults"] = usage.ru_minflt - faults;
+
+    ValueType sum;
+    for (auto _ : state){
+        sum = pad::reduce(pad::exec::numa, X.begin(), X.end());
+        benchmark::DoNotOptimize(&sum);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(ValueType));
+    setCustomCounter(state, std::string("ReduceNumaHugePagesV3-") + numa::name(Mode));
+}
+
+// Arenas and pool shared by every size of the sweep, the pool filled once
+// with enough slabs for the largest size (1 vector of 2^30)
+static numa::pool_fixture& poolFixture() {
+    static numa::pool_fixture fixture(thrds_per_node, (std::size_t{1} << 30) * sizeof(ValueType));
+    return fixture;
+}
+
+// benchReduceTbbNoInit2V3 on pool memory: the container lands on slabs the
+// arenas already faulted in, so the setup only writes the values.
+static void benchReduceTbbPoolV3(benchmark::State& state){
+    auto& [arenas, pool] = poolFixture();
+    pool.reset_stats();
+    Partitioner part;
+
+    const auto start = std::chrono::steady_clock::now();
+    ContainerTypePool X(state.range(0), PoolAllocator(pool));
+    numa::first_touch(X, arenas, part, ValueType{1});
+    const std::chrono::duration<double> setup = std::chrono::steady_clock::now() - start;
+
+    ValueType part_sum;
+    std::atomic<ValueType> total_sum;
+    for (auto _ : state){
+        total_sum = 0;
+        #pragma omp parallel private(part_sum) shared(total_sum)
+        {
+            auto mth = omp_get_thread_num();
+            auto [start, end] = arenas.index_range(mth, X.size());
+            auto s = start;
+            auto e = end;
+            part_sum = arenas[mth]->execute([&]() -> ValueType {
+                return pad::reduce(pad::exec::tbb, X.begin() + s, X.begin() + e, part);
+            });
+            total_sum += part_sum;
+        }
+
+        benchmark::DoNotOptimize(&total_sum);
+        benchmark::ClobberMemory();
+    }
+    numa::set_pool_counters(state, pool, setup.count());
+    setCustomCounter(state, "ReduceTbbPoolV3");
+}
+
 BENCHMARK(benchReduceTbbNoInitV3)->Apply(Args)->UseRealTime()->Iterations(100);
 BENCHMARK(benchReduceTbbNoInit2V3)->Apply(Args)->UseRealTime()->Iterations(100);
-BENCHMARK_MAIN();
+BENCHMARK(benchReduceTbbPoolV3)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaV3, false)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaV3, true)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaAccurateV3, pad::exec::summation::kahan)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaAccurateV3, pad::exec::summation::neumaier)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaAccurateV3, pad::exec::summation::pairwise)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaAccurateV3, pad::exec::summation::widened)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaHugePagesV3, numa::huge_pages::none)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaHugePagesV3, numa::huge_pages::transparent)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaHugePagesV3, numa::huge_pages::hugetlb_2m)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchReduceNumaHugePagesV3, numa::huge_pages::hugetlb_1g)->Apply(Args)->UseRealTime()->Iterations(100);
+PAD_BENCHMARK_MAIN();
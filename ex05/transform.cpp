@@ -13,6 +13,8 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "allocator_adaptor.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
@@ -60,11 +62,7 @@ static void benchTransformTbbNoInit(benchmark::State& state){
                     tbb::task_arena numa_arena{thrds_per_node};
                     numa::PinningObserver p{numa_arena, topo, i, thrds_per_node};
                     numa_arena.execute([&](){
-                        tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
-                            for(size_t j = r.begin(); j < r.end(); j++){
-                                Y[i * size + j] = alpha * X[i * size + j] + Y[i * size + j];
-                            }
-                        }, part);
+                        pad::transform(pad::exec::tbb, alpha, X.begin() + i * size, X.begin() + (i + 1) * size, Y.begin() + i * size, part);
                     });
                 }
             });
@@ -106,7 +104,7 @@ static void benchTransformTbbNoInit2(benchmark::State& state){
                     tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
                         for(size_t j = r.begin(); j < r.end(); j++){
                             new(&X[i * size + j]) ContainerTypeNoInit::value_type{1};
-                            new(&X[i * size + j]) ContainerTypeNoInit::value_type{2};
+                            new(&Y[i * size + j]) ContainerTypeNoInit::value_type{2};
                         }
                     }, part);                 
                 });
@@ -128,11 +126,7 @@ static void benchTransformTbbNoInit2(benchmark::State& state){
                     tbb::task_arena numa_arena{thrds_per_node};
                     numa::PinningObserver p{numa_arena, topo, i, thrds_per_node};
                     numa_arena.execute([&](){
-                        tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
-                            for(size_t j = r.begin(); j < r.end(); j++){
-                                Y[i * size + j] = alpha * X[i * size + j] + Y[i * size + j];
-                            }
-                        }, part);
+                        pad::transform(pad::exec::tbb, alpha, X.begin() + i * size, X.begin() + (i + 1) * size, Y.begin() + i * size, part);
                     });
                 }
             });
@@ -152,4 +146,4 @@ static void benchTransformTbbNoInit2(benchmark::State& state){
 
 BENCHMARK(benchTransformTbbNoInit)->Apply(Args)->UseRealTime()->Iterations(100);
 BENCHMARK(benchTransformTbbNoInit2)->Apply(Args)->UseRealTime()->Iterations(100);
-BENCHMARK_MAIN();
\ No newline at end of file
+PAD_BENCHMARK_MAIN();
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "allocator_adaptor.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
@@ -75,11 +77,7 @@ static void benchTransformTbbNoInitV2(benchmark::State& state){
         #pragma omp parallel for
         for (int i = 0; i < num_nodes; i++){
             numa_arenas[i].execute([&](){
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
-                    for(size_t j = r.begin(); j < r.end(); j++){
-                        Y[i * size + j] = alpha * X[i * size + j] + Y[i * size + j];
-                    }
-                }, part);
+                pad::transform(pad::exec::tbb, alpha, X.begin() + i * size, X.begin() + (i + 1) * size, Y.begin() + i * size, part);
             });
         }
 
@@ -113,7 +111,7 @@ static void benchTransformTbbNoInit2V2(benchmark::State& state){
             tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
                 for(size_t j = r.begin(); j < r.end(); j++){
                     new(&X[i * size + j]) ContainerTypeNoInit::value_type{1};
-                    new(&X[i * size + j]) ContainerTypeNoInit::value_type{2};
+                    new(&Y[i * size + j]) ContainerTypeNoInit::value_type{2};
                 }
             }, part);                
         });
@@ -123,11 +121,7 @@ static void benchTransformTbbNoInit2V2(benchmark::State& state){
         #pragma omp parallel for
         for (int i = 0; i < num_nodes; i++){
             numa_arenas[i].execute([&](){
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, size), [&](const tbb::blocked_range<size_t> r){
-                    for(size_t j = r.begin(); j < r.end(); j++){
-                        Y[i * size + j] = alpha * X[i * size + j] + Y[i * size + j];
-                    }
-                }, part);
+                pad::transform(pad::exec::tbb, alpha, X.begin() + i * size, X.begin() + (i + 1) * size, Y.begin() + i * size, part);
             }
         );}
 
@@ -143,4 +137,4 @@ static void benchTransformTbbNoInit2V2(benchmark::State& state){
 
 BENCHMARK(benchTransformTbbNoInitV2)->Apply(Args)->UseRealTime()->Iterations(100);
 BENCHMARK(benchTransformTbbNoInit2V2)->Apply(Args)->UseRealTime()->Iterations(100);
-BENCHMARK_MAIN();
\ No newline at end of file
+PAD_BENCHMARK_MAIN();
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <vector>
+#include <chrono>
+#include <string>
 #include <algorithm>
 #include <thread>
 #include <future>
@@ -14,9 +16,15 @@
 #include <oneapi/tbb/partitioner.h>
 
 #include "arena.hpp"
+#include "first_touch.hpp"
+#include "pool_allocator.hpp"
+#include "pad/bench.hpp"
+#include "pad/kernels.hpp"
 
 using ValueType = float;
 using ContainerTypeNoInit = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
+using PoolAllocator = numa::no_init_allocator<ValueType, numa::pool_allocator<ValueType>>;
+using ContainerTypePool = std::vector<ValueType, PoolAllocator>;
 using Partitioner = tbb::static_partitioner;
 
 static constexpr int thrds_per_node = 16;
@@ -33,6 +41,8 @@ static void Args(benchmark::internal::Benchmark* b) {
 void setCustomCounter(benchmark::State& state, std::string name) {
   state.counters["Elements"] = state.range(0);
   state.counters["Bytes"] = 3 * state.range(0) * sizeof(ValueType);
+  state.SetBytesProcessed(state.iterations() * 3 * state.range(0) *
+                          sizeof(ValueType));
   state.SetLabel(name);
 }
 
@@ -60,12 +70,7 @@ static void benchTransformTbbNoInitV3(benchmark::State& state){
             auto s = start;
             auto e = end;
             arenas[mth]->execute([&](){
-                tbb::parallel_for(tbb::blocked_range<size_t>(s, e), [&](const tbb::blocked_range<size_t> r){
-                    #pragma omp simd
-                    for(size_t i = r.begin(); i < r.end(); i++){
-                        Y[i] = alpha * X[i] + Y[i];
-                    }
-                }, part);
+                pad::transform(pad::exec::tbb, alpha, X.begin() + s, X.begin() + e, Y.begin() + s, part);
             });
         }
 
@@ -84,21 +89,8 @@ static void benchTransformTbbNoInit2V3(benchmark::State& state){
     Partitioner part;
     const ValueType alpha = 2;
 
-    #pragma omp parallel
-    {
-        auto mth = omp_get_thread_num();
-        auto [start, end] = arenas.index_range(mth, X.size());
-        auto s = start;
-        auto e = end;
-        arenas[mth]->execute([&](){
-            tbb::parallel_for(tbb::blocked_range<size_t>(s, e), [&](const tbb::blocked_range<size_t> r){
-                for(size_t i = r.begin(); i < r.end(); i++){
-                    new(&X[i]) ContainerTypeNoInit::value_type{1};
-                    new(&X[i]) ContainerTypeNoInit::value_type{2};
-                }
-            }, part);                
-        });
-    }
+    numa::first_touch(X, arenas, part, ValueType{1});
+    numa::first_touch(Y, arenas, part, ValueType{2});
 
     for (auto _ : state){
         #pragma omp parallel
@@ -108,12 +100,7 @@ static void benchTransformTbbNoInit2V3(benchmark::State& state){
             auto s = start;
             auto e = end;
             arenas[mth]->execute([&](){
-                tbb::parallel_for(tbb::blocked_range<size_t>(s, e), [&](const tbb::blocked_range<size_t> r){
-                    #pragma omp simd
-                    for(size_t i = r.begin(); i < r.end(); i++){
-                        Y[i] = alpha * X[i] + Y[i];
-                    }
-                }, part);
+                pad::transform(pad::exec::tbb, alpha, X.begin() + s, X.begin() + e, Y.begin() + s, part);
             }
         );}
 
@@ -125,6 +112,98 @@ static void benchTransformTbbNoInit2V3(benchmark::State& state){
     setCustomCounter(state, "TransformTbbNoInit2V3");
 }
 
+// Arenas and pool shared by every size of the sweep, the pool filled once
+// with enough slabs for the largest size (2 vectors of 2^30)
+static numa::pool_fixture& poolFixture() {
+    static numa::pool_fixture fixture(thrds_per_node, 2 * (std::size_t{1} << 30) * sizeof(ValueType));
+    return fixture;
+}
+
+// benchTransformTbbNoInit2V3 on pool memory: X and Y land on slabs the
+// arenas already faulted in, so the setup only writes the values.
+static void benchTransformTbbPoolV3(benchmark::State& state){
+    auto& [arenas, pool] = poolFixture();
+    pool.reset_stats();
+    Partitioner part;
+    const ValueType alpha = 2;
+
+    const auto start = std::chrono::steady_clock::now();
+    ContainerTypePool X(state.range(0), PoolAllocator(pool));
+    ContainerTypePool Y(state.range(0), PoolAllocator(pool));
+    numa::first_touch(X, arenas, part, ValueType{1});
+    numa::first_touch(Y, arenas, part, ValueType{2});
+    const std::chrono::duration<double> setup = std::chrono::steady_clock::now() - start;
+
+    for (auto _ : state){
+        #pragma omp parallel
+        {
+            auto mth = omp_get_thread_num();
+            auto [start, end] = arenas.index_range(mth, X.size());
+            auto s = start;
+            auto e = end;
+            arenas[mth]->execute([&](){
+                pad::transform(pad::exec::tbb, alpha, X.begin() + s, X.begin() + e, Y.begin() + s, part);
+            });
+        }
+
+        benchmark::DoNotOptimize(Y.data());
+        benchmark::ClobberMemory();
+    }
+    numa::set_pool_counters(state, pool, setup.count());
+    setCustomCounter(state, "TransformTbbPoolV3");
+}
+
+// NoInitV3 with the given store hint, in place (Y) or out of place into Z
+template <pad::exec::store_hint Hint, bool OutOfPlace>
+static void benchTransformTbbNoInitStoresV3(benchmark::State& state){
+    numa::ArenaMgtTBB arenas(thrds_per_node);
+
+    ContainerTypeNoInit X(state.range(0));
+    ContainerTypeNoInit Y(state.range(0));
+    ContainerTypeNoInit Z(OutOfPlace ? state.range(0) : 0);
+    Partitioner part;
+    const ValueType alpha = 2;
+    const auto policy = pad::exec::stores(pad::exec::tbb, Hint);
+
+    #pragma omp parallel
+    {
+        auto mth = omp_get_thread_num();
+        auto [start, end] = arenas.index_range(mth, X.size());
+        std::uninitialized_fill(std::execution::unseq, X.begin() + start, X.begin() + end, 1);
+        std::uninitialized_fill(std::execution::unseq, Y.begin() + start, Y.begin() + end, 2);
+        if constexpr (OutOfPlace) {
+            std::uninitialized_fill(std::execution::unseq, Z.begin() + start, Z.begin() + end, 0);
+        }
+    }
+
+    for (auto _ : state){
+        #pragma omp parallel
+        {
+            auto mth = omp_get_thread_num();
+            auto [start, end] = arenas.index_range(mth, X.size());
+            auto s = start;
+            auto e = end;
+            arenas[mth]->execute([&](){
+                if constexpr (OutOfPlace) {
+                    pad::transform_to(policy, alpha, X.begin() + s, X.begin() + e, Y.begin() + s, Z.begin() + s, part);
+                } else {
+                    pad::transform(policy, alpha, X.begin() + s, X.begin() + e, Y.begin() + s, part);
+                }
+            });
+        }
+
+        benchmark::DoNotOptimize(OutOfPlace ? Z.data() : Y.data());
+        benchmark::ClobberMemory();
+    }
+
+    setCustomCounter(state, std::string(OutOfPlace ? "TransformToTbbNoInitV3-" : "TransformTbbNoInitV3-") + pad::exec::name(Hint));
+}
+
 BENCHMARK(benchTransformTbbNoInitV3)->Apply(Args)->UseRealTime()->Iterations(100);
 BENCHMARK(benchTransformTbbNoInit2V3)->Apply(Args)->UseRealTime()->Iterations(100);
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK(benchTransformTbbPoolV3)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStoresV3, pad::exec::store_hint::non_temporal, false)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStoresV3, pad::exec::store_hint::temporal, true)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStoresV3, pad::exec::store_hint::non_temporal, true)->Apply(Args)->UseRealTime()->Iterations(100);
+BENCHMARK_TEMPLATE(benchTransformTbbNoInitStoresV3, pad::exec::store_hint::automatic, true)->Apply(Args)->UseRealTime()->Iterations(100);
+PAD_BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,377 @@
+#pragma once
+
+// Allocator adaptors of the exercises: construction that leaves elements
+// uninitialized (default_init, no_init), cache-line alignment, hwloc memory
+// binding and huge pages. They rebind to one another and so stack, e.g.
+// no_init_allocator<T, aligned_allocator<T>>.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <hwloc.h>
+#include <sys/mman.h>
+
+namespace numa {
+template <typename T, typename A = std::allocator<T>>
+class default_init_allocator : public A {
+  // Implementation taken from https://stackoverflow.com/a/21028912
+  // see also https://hackingcpp.com/cpp/recipe/uninitialized_numeric_array.html
+ public:
+  using A::A;
+
+  template <typename U>
+  struct rebind {
+    using other = default_init_allocator<
+        U,
+        typename std::allocator_traits<A>::template rebind_alloc<U>>;
+  };
+
+  template <typename U>
+  void construct(U* ptr) noexcept(
+      std::is_nothrow_default_constructible<U>::value) {
+    ::new (static_cast<void*>(ptr)) U;
+  }
+  template <typename U, typename... ArgsT>
+  void construct(U* ptr, ArgsT&&... args) {
+    std::allocator_traits<A>::construct(static_cast<A&>(*this), ptr,
+                                        std::forward<ArgsT>(args)...);
+  }
+};
+
+template <typename T, typename A = std::allocator<T>>
+class no_init_allocator : public A {
+  // Implementation adapted from https://stackoverflow.com/a/21028912
+  // see also https://hackingcpp.com/cpp/recipe/uninitialized_numeric_array.html
+ public:
+  using A::A;
+
+  template <typename U>
+  struct rebind {
+    using other = no_init_allocator<
+        U,
+        typename std::allocator_traits<A>::template rebind_alloc<U>>;
+  };
+
+  template <typename U, typename... ArgsT>
+  void construct(U* ptr, ArgsT&&... args) { }
+};
+
+// Allocator layer whose blocks start on an Align-byte boundary (a cache line
+// by default), taken from A with Align bytes to spare. The pointer A
+// returned sits just below the aligned block. Stacks like the adaptors
+// above, e.g. no_init_allocator<T, aligned_allocator<T, 64>> or
+// aligned_allocator<T, 64, membind_allocator<T>>.
+template <typename T, std::size_t Align = 64, typename A = std::allocator<T>>
+class aligned_allocator : public A {
+  static_assert((Align & (Align - 1)) == 0 && Align >= alignof(void*),
+                "Align must be a power of two of at least alignof(void*)");
+
+ public:
+  using A::A;
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = aligned_allocator<
+        U, Align, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+  };
+
+  aligned_allocator() = default;
+
+  template <typename U, typename B>
+  aligned_allocator(const aligned_allocator<U, Align, B>& other)
+      : A(static_cast<const B&>(other)) {}
+
+  T* allocate(std::size_t n) {
+    T* raw = std::allocator_traits<A>::allocate(static_cast<A&>(*this),
+                                                n + spare);
+    const auto base = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    auto* p = reinterpret_cast<T*>((base + Align - 1) / Align * Align);
+    reinterpret_cast<T**>(p)[-1] = raw;
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    std::allocator_traits<A>::deallocate(static_cast<A&>(*this),
+                                         reinterpret_cast<T**>(p)[-1],
+                                         n + spare);
+  }
+
+ private:
+  // Elements of T that cover the alignment slack and the saved pointer
+  static constexpr std::size_t spare =
+      (Align + sizeof(void*) + sizeof(T) - 1) / sizeof(T);
+};
+
+// Where membind_allocator places the pages it hands out: all on one node,
+// round-robin over all nodes, on the node of the thread that first writes
+// each page, or migrated to the node of the next thread that touches it.
+enum class membind { bind, interleave, first_touch, next_touch };
+
+inline const char* name(membind policy) {
+  switch (policy) {
+    case membind::bind:
+      return "bind";
+    case membind::interleave:
+      return "interleave";
+    case membind::first_touch:
+      return "first_touch";
+    default:
+      return "next_touch";
+  }
+}
+
+// Topology shared by every membind_allocator, loaded on first use.
+inline hwloc_topology_t membind_topology() {
+  static const hwloc_topology_t topology = [] {
+    hwloc_topology_t topo;
+    hwloc_topology_init(&topo);
+    hwloc_topology_load(topo);
+    return topo;
+  }();
+  return topology;
+}
+
+// Nodeset and hwloc policy for `policy`, `node` only used by bind.
+inline hwloc_membind_policy_t membind_nodeset(membind policy, int node,
+                                              hwloc_nodeset_t set) {
+  hwloc_topology_t topo = membind_topology();
+  if (policy == membind::bind) {
+    hwloc_obj_t obj = hwloc_get_obj_by_type(topo, HWLOC_OBJ_NUMANODE, node);
+    hwloc_bitmap_copy(set, obj ? obj->nodeset
+                               : hwloc_topology_get_topology_nodeset(topo));
+    return HWLOC_MEMBIND_BIND;
+  }
+  hwloc_bitmap_copy(set, hwloc_topology_get_topology_nodeset(topo));
+  switch (policy) {
+    case membind::interleave:
+      return HWLOC_MEMBIND_INTERLEAVE;
+    case membind::first_touch:
+      return HWLOC_MEMBIND_FIRSTTOUCH;
+    default:
+      return HWLOC_MEMBIND_NEXTTOUCH;
+  }
+}
+
+// Whether the OS applies `policy`, both to hwloc_alloc_membind and to
+// set_membind. Linux has no next-touch.
+inline bool membind_supported(membind policy) {
+  const hwloc_topology_support* support =
+      hwloc_topology_get_support(membind_topology());
+  if (!support->membind->alloc_membind || !support->membind->set_area_membind) {
+    return false;
+  }
+  switch (policy) {
+    case membind::bind:
+      return support->membind->bind_membind;
+    case membind::interleave:
+      return support->membind->interleave_membind;
+    case membind::first_touch:
+      return support->membind->firsttouch_membind;
+    default:
+      return support->membind->nexttouch_membind &&
+             support->membind->migrate_membind;
+  }
+}
+
+// Allocator that places its memory with hwloc_alloc_membind, the policy
+// chosen per container:
+//   membind_allocator<T> alloc(membind::interleave);
+//   std::vector<T, membind_allocator<T>> X(n, alloc);
+// Wrap it in no_init_allocator to keep the vector from touching the pages.
+// Where the OS lacks a policy the memory comes from plain hwloc_alloc, i.e.
+// first touch; check membind_supported before reporting a policy as used.
+template <typename T>
+class membind_allocator {
+ public:
+  using value_type = T;
+  using is_always_equal = std::true_type;  // any of them can free any block
+
+  explicit membind_allocator(membind policy = membind::first_touch,
+                             int node = 0) noexcept
+      : policy_(policy), node_(node) {}
+
+  template <typename U>
+  membind_allocator(const membind_allocator<U>& other) noexcept
+      : policy_(other.policy()), node_(other.node()) {}
+
+  T* allocate(std::size_t n) {
+    hwloc_topology_t topo = membind_topology();
+    const std::size_t bytes = n * sizeof(T);
+    hwloc_nodeset_t set = hwloc_bitmap_alloc();
+    const hwloc_membind_policy_t p = membind_nodeset(policy_, node_, set);
+    void* ptr =
+        hwloc_alloc_membind(topo, bytes, set, p, HWLOC_MEMBIND_BYNODESET);
+    hwloc_bitmap_free(set);
+    if (ptr == nullptr) ptr = hwloc_alloc(topo, bytes);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    hwloc_free(membind_topology(), ptr, n * sizeof(T));
+  }
+
+  membind policy() const noexcept { return policy_; }
+  int node() const noexcept { return node_; }
+
+ private:
+  membind policy_;
+  int node_;
+};
+
+template <typename T, typename U>
+bool operator==(const membind_allocator<T>&, const membind_allocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const membind_allocator<T>&, const membind_allocator<U>&) {
+  return false;
+}
+
+// Re-places the pages of p[0, n) already allocated, e.g. next_touch after a
+// serial initialization so that the threads of the compute phase pull their
+// share over. HWLOC_MEMBIND_MIGRATE moves pages that are already resident.
+// False if the OS refused.
+template <typename T>
+bool set_membind(const T* p, std::size_t n, membind policy, int node = 0) {
+  hwloc_nodeset_t set = hwloc_bitmap_alloc();
+  const hwloc_membind_policy_t hp = membind_nodeset(policy, node, set);
+  const int err = hwloc_set_area_membind(
+      membind_topology(), p, n * sizeof(T), set, hp,
+      HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_MIGRATE);
+  hwloc_bitmap_free(set);
+  return err == 0;
+}
+
+// Page size huge_page_allocator maps with: 4 KiB pages even where THP is on
+// by default, transparent 2 MiB pages (2 MiB-aligned, madvise(MADV_HUGEPAGE)),
+// or explicit MAP_HUGETLB pages of 2 MiB or 1 GiB from the hugetlbfs pool.
+enum class huge_pages { none, transparent, hugetlb_2m, hugetlb_1g };
+
+inline const char* name(huge_pages mode) {
+  switch (mode) {
+    case huge_pages::none:
+      return "none";
+    case huge_pages::transparent:
+      return "transparent";
+    case huge_pages::hugetlb_2m:
+      return "hugetlb_2m";
+    default:
+      return "hugetlb_1g";
+  }
+}
+
+inline std::size_t page_bytes(huge_pages mode) {
+  switch (mode) {
+    case huge_pages::none:
+      return 4096;
+    case huge_pages::hugetlb_1g:
+      return std::size_t{1} << 30;
+    default:
+      return std::size_t{1} << 21;
+  }
+}
+
+// Anonymous mapping of `bytes` (a multiple of page_bytes(mode)) aligned to
+// page_bytes(mode). The hugetlb modes fall back to transparent pages when
+// the pool is empty or the kernel lacks them, and transparent to none when
+// madvise is refused; `granted` receives the mode actually mapped.
+inline void* map_pages(std::size_t bytes, huge_pages mode,
+                       huge_pages* granted = nullptr) {
+  if (mode == huge_pages::hugetlb_2m || mode == huge_pages::hugetlb_1g) {
+    const int log2 = mode == huge_pages::hugetlb_1g ? 30 : 21;
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                       (log2 << MAP_HUGE_SHIFT),
+                   -1, 0);
+    if (p != MAP_FAILED) {
+      if (granted) *granted = mode;
+      return p;
+    }
+  }
+  // Over-map by one alignment unit and trim both ends
+  const std::size_t align = page_bytes(mode);
+  const std::size_t span = bytes + align;
+  void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) return nullptr;
+  const auto begin = reinterpret_cast<std::uintptr_t>(raw);
+  const auto aligned = (begin + align - 1) / align * align;
+  if (aligned > begin) munmap(raw, aligned - begin);
+  if (begin + span > aligned + bytes) {
+    munmap(reinterpret_cast<void*>(aligned + bytes),
+           begin + span - aligned - bytes);
+  }
+  void* p = reinterpret_cast<void*>(aligned);
+  // Without THP in the kernel both advices fail and the pages are 4 KiB
+  const bool thp = mode != huge_pages::none &&
+                   madvise(p, bytes, MADV_HUGEPAGE) == 0;
+  if (mode == huge_pages::none) madvise(p, bytes, MADV_NOHUGEPAGE);
+  if (granted) *granted = thp ? huge_pages::transparent : huge_pages::none;
+  return p;
+}
+
+// Allocator that maps every allocation on its own, in pages of the mode
+// chosen per container:
+//   huge_page_allocator<T> alloc(huge_pages::hugetlb_1g);
+//   std::vector<T, huge_page_allocator<T>> X(n, alloc);
+// Nothing is touched on allocation, so wrapped in no_init_allocator the
+// pages are still placed by first touch, 2 MiB or 1 GiB at a time.
+template <typename T>
+class huge_page_allocator {
+ public:
+  using value_type = T;
+  // Blocks are unmapped with the length of their mode, so only allocators
+  // of the same mode may free each other's memory
+  using propagate_on_container_move_assignment = std::true_type;
+
+  explicit huge_page_allocator(
+      huge_pages mode = huge_pages::transparent) noexcept
+      : mode_(mode) {}
+
+  template <typename U>
+  huge_page_allocator(const huge_page_allocator<U>& other) noexcept
+      : mode_(other.mode()) {}
+
+  T* allocate(std::size_t n) {
+    void* p = map_pages(length(n), mode_, &granted_);
+    if (p == nullptr) throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept { munmap(p, length(n)); }
+
+  huge_pages mode() const noexcept { return mode_; }
+  // Mode the last allocation was actually mapped with, mode() before any;
+  // check it against mode() before reporting results under mode()
+  huge_pages granted() const noexcept { return granted_; }
+
+ private:
+  // Bytes mapped for n elements, also when the hugetlb modes fell back
+  std::size_t length(std::size_t n) const noexcept {
+    const std::size_t page = page_bytes(mode_);
+    return (std::max<std::size_t>(n * sizeof(T), 1) + page - 1) / page * page;
+  }
+
+  huge_pages mode_;
+  huge_pages granted_ = mode_;
+};
+
+template <typename T, typename U>
+bool operator==(const huge_page_allocator<T>& a,
+                const huge_page_allocator<U>& b) {
+  return a.mode() == b.mode();
+}
+
+template <typename T, typename U>
+bool operator!=(const huge_page_allocator<T>& a,
+                const huge_page_allocator<U>& b) {
+  return !(a == b);
+}
+}  // namespace numa
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+// Google Benchmark entry point for benchmarks built on pad-kernels. Include
+// after <benchmark/benchmark.h> and use in place of BENCHMARK_MAIN().
+
+#include <string>
+
+#include "pad/isa.hpp"
+#include "pad/tuning.hpp"
+
+#define PAD_BENCHMARK_MAIN()                                                \
+  int main(int argc, char** argv) {                                         \
+    ::benchmark::Initialize(&argc, argv);                                   \
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;     \
+    ::benchmark::AddCustomContext(                                          \
+        "pad_isa", ::pad::isa::name(::pad::isa::kernels().isa));            \
+    ::benchmark::AddCustomContext(                                          \
+        "pad_tuning", ::pad::tuning::loaded_from().empty()                  \
+                          ? std::string("none")                             \
+                          : ::pad::tuning::loaded_from());                  \
+    ::benchmark::AddCustomContext(                                          \
+        "pad_tbb_tuning", ::pad::tuning::tbb_loaded_from().empty()          \
+                              ? std::string("none")                         \
+                              : ::pad::tuning::tbb_loaded_from());          \
+    ::benchmark::RunSpecifiedBenchmarks();                                  \
+    ::benchmark::Shutdown();                                                \
+    return 0;                                                               \
+  }                                                                         \
+  int main(int, char**)
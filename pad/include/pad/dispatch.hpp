@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+namespace dispatch {
+
+// Paths exec::adaptive chooses between.
+enum class backend { serial, omp, tbb, numa };
+inline constexpr int backend_count = 4;
+
+enum class kernel { reduce, transform };
+
+// "serial", "omp", "tbb", "numa"
+const char* name(backend b);
+
+// Backend called `name`; false if there is none.
+bool from_name(const char* name, backend& b);
+
+// Time of one call in seconds, piecewise linear: overhead + n * per_element
+// up to `knee` elements, the largest size calibrated in cache, then
+// per_element_beyond for every element past it.
+struct cost {
+  double overhead;
+  double per_element;
+  index_type knee;
+  double per_element_beyond;
+
+  double operator()(index_type n) const {
+    if (n <= knee) return overhead + n * per_element;
+    return overhead + knee * per_element + (n - knee) * per_element_beyond;
+  }
+};
+
+// Costs of the float kernels of every backend on this host, indexed by
+// backend; the omp entry is the one of the largest team. omp_reduce[i] and
+// omp_transform[i] are the costs with omp_threads[i] threads.
+struct calibration {
+  cost reduce[backend_count];
+  cost transform[backend_count];
+  std::vector<int> omp_threads;
+  std::vector<cost> omp_reduce;
+  std::vector<cost> omp_transform;
+};
+
+// Costs measured on first use, from three sizes per backend and kernel: a
+// small one, one that fits the last-level caches and one twice their total
+// size (a second or two, longer with hundreds of MiB of cache). Every backend
+// is timed in the arena and OpenMP setting of that first call, the numa
+// backend on node-local pages.
+const calibration& calibrated();
+
+// The path exec::adaptive takes for n float elements: the cheapest backend
+// according to calibrated(), and for omp the team size. $PAD_DISPATCH
+// (serial, omp, tbb, numa) forces a backend.
+struct decision {
+  backend path;
+  int threads;
+};
+
+decision choose(kernel k, index_type n);
+
+}  // namespace dispatch
+}  // namespace pad
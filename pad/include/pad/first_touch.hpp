@@ -0,0 +1,109 @@
+#pragma once
+
+// First-touch initialization of containers whose allocator leaves the pages
+// untouched: each element is constructed by the thread of the policy that
+// will later stream it, so its page lands on that thread's node.
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <omp.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/numa.hpp"
+
+namespace numa {
+namespace detail {
+// gen(i) if the generator takes an index, else the generator is the value
+template <typename Generator>
+decltype(auto) generate(Generator& gen, std::size_t i) {
+  if constexpr (std::is_invocable_v<Generator&, std::size_t>) {
+    return gen(i);
+  } else {
+    return (gen);
+  }
+}
+
+// Constructs p[i] for i in [first, last) from the generator, in place
+template <typename T, typename Generator>
+void touch(T* p, std::size_t first, std::size_t last, Generator& gen) {
+  for (std::size_t i = first; i < last; ++i) {
+    ::new (static_cast<void*>(p + i)) T(generate(gen, i));
+  }
+}
+
+// tbb::parallel_for over [offset, offset + n), the range counted in elements
+// and split by `part` with grain_size elements. A static_partitioner cuts it
+// in proportion to its length, so each thread's share matches the kernel's
+// to within one of the kernel's units (element, simd block or line).
+template <typename T, typename Partitioner, typename Generator>
+void touch_tbb(T* p,
+               std::size_t offset,
+               std::size_t n,
+               Partitioner& part,
+               std::size_t grain_size,
+               Generator& gen) {
+  tbb::parallel_for(
+      tbb::blocked_range<std::size_t>(0, n, grain_size),
+      [&](const tbb::blocked_range<std::size_t>& r) {
+        touch(p, offset + r.begin(), offset + r.end(), gen);
+      },
+      part);
+}
+}  // namespace detail
+
+// First-touch initialization of a container allocated without touching its
+// pages (no_init_allocator, default_init_allocator, membind first_touch):
+// every element is constructed by the thread that will later stream it, so
+// its page is faulted in on that thread's node. The generator is either a
+// value or a function of the element index. Pass the partitioning object of
+// the compute loop:
+//
+//   tbb::static_partitioner part;
+//   numa::first_touch(X, part, 1.0f);
+//   pad::reduce(pad::exec::tbb, X.begin(), X.end(), part);
+//
+// A tbb partitioner. grain_size counts elements, while the kernels count
+// their grain in their own unit: elements for pad::transform, simd_width
+// blocks for pad::reduce and cache lines for the assume_aligned overloads.
+// Convert before passing it on, e.g. grain * pad::simd_width for reduce.
+template <typename Container, typename Partitioner, typename Generator>
+void first_touch(Container& c,
+                 Partitioner& part,
+                 Generator gen,
+                 std::size_t grain_size = 1) {
+  detail::touch_tbb(c.data(), 0, c.size(), part, grain_size, gen);
+}
+
+// An OpenMP team of policy.threads threads (the default team size if 0), one
+// schedule(static) chunk per thread as in pad's omp kernels
+template <typename Container, typename Generator>
+void first_touch(Container& c, pad::exec::omp_policy policy, Generator gen) {
+  const pad::index_type n = c.size();
+  auto* p = c.data();
+  const int threads =
+      policy.threads > 0 ? policy.threads : omp_get_max_threads();
+#pragma omp parallel num_threads(threads)
+  {
+    pad::index_type begin, end;
+    pad::detail::static_chunk(n, omp_get_thread_num(), omp_get_num_threads(),
+                              begin, end);
+    detail::touch(p, begin, end, gen);
+  }
+}
+
+// The arenas of pad::numa, each node's share with a static_partitioner as in
+// pad's numa kernels
+template <typename Container, typename Generator>
+void first_touch(Container& c, pad::exec::numa_policy, Generator gen) {
+  auto* p = c.data();
+  pad::numa::for_each_node(
+      c.size(), [p, &gen](int, pad::index_type begin, pad::index_type end) {
+        tbb::static_partitioner part;
+        detail::touch_tbb(p, begin, end - begin, part, 1, gen);
+      });
+}
+}  // namespace numa
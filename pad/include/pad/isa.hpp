@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+namespace isa {
+
+// ISA levels the float kernels are built for, in increasing order.
+enum class level { sse42, avx2, avx512f };
+
+const char* name(level isa);
+
+// Level called `name`; false if there is none.
+bool from_name(const char* name, level& isa);
+
+// Best level supported by both the CPU and the OS, from cpuid and xgetbv.
+level detect();
+
+// One kernel of the compile-time grid in pad/kernels/variants.hpp.
+template <typename T>
+struct kernel_variant {
+  int width;
+  int unroll;
+  bool aligned;
+  T (*reduce)(const T* x, index_type n);
+  void (*transform)(T a, const T* x, T* y, index_type n);
+};
+
+// Entry points of one per-ISA build of the kernels.
+struct kernel_table {
+  level isa;
+  // acc[0, simd_width) += vertical sums of x[0, n)
+  void (*reduce_f32)(const float* x,
+                     index_type n,
+                     std::array<float, simd_width>& acc);
+  // y[0, n) = a * x[0, n) + y[0, n)
+  void (*transform_f32)(float a, const float* x, float* y, index_type n);
+  // As above, for an x that starts on a cache_line boundary
+  void (*reduce_aligned_f32)(const float* x,
+                             index_type n,
+                             std::array<float, simd_width>& acc);
+  void (*transform_aligned_f32)(float a,
+                                const float* x,
+                                float* y,
+                                index_type n);
+  // z[0, n) = a * x[0, n) + y[0, n); z may be y. The stream variant writes z
+  // with non-temporal stores and fences them before it returns.
+  void (*transform_to_f32)(float a,
+                           const float* x,
+                           const float* y,
+                           float* z,
+                           index_type n);
+  void (*transform_stream_f32)(float a,
+                               const float* x,
+                               const float* y,
+                               float* z,
+                               index_type n);
+  // As the first two, prefetching `distance` elements ahead
+  void (*reduce_prefetch_f32)(const float* x,
+                              index_type n,
+                              std::array<float, simd_width>& acc,
+                              index_type distance);
+  void (*transform_prefetch_f32)(float a,
+                                 const float* x,
+                                 float* y,
+                                 index_type n,
+                                 index_type distance);
+  // The kernel grid for float, variant_count entries
+  const kernel_variant<float>* variants_f32;
+};
+
+// Kernel table chosen on first use: the detected level, lowered to the value
+// of the PAD_ISA environment variable (sse42, avx2, avx512f) if that is set.
+const kernel_table& kernels();
+
+// Kernel table of a given level. Only call the kernels of a level the CPU
+// supports, see detect().
+const kernel_table& kernels(level isa);
+
+}  // namespace isa
+}  // namespace pad
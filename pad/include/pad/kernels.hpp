@@ -0,0 +1,13 @@
+#pragma once
+
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/generic.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/kernels/stream.hpp"
+#include "pad/kernels/aligned.hpp"
+#include "pad/kernels/deterministic.hpp"
+#include "pad/kernels/accurate.hpp"
+#include "pad/kernels/tuned.hpp"
+#include "pad/kernels/adaptive.hpp"
+#include "pad/kernels/steal.hpp"
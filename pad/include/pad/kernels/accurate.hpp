@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cmath>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/numa.hpp"
+
+// The compensated sums need every add rounded as written: a compiler allowed
+// to reassociate (-ffast-math, icpx's default -fp-model=fast) cancels their
+// correction terms. The functions that compute them opt out of fast math,
+// PAD_FP_PRECISE on the declaration and PAD_FP_PRECISE_SCOPE first in the
+// body, so the rest of a fast-math build keeps its flags.
+#if defined(__clang__)
+#define PAD_FP_PRECISE
+#define PAD_FP_PRECISE_SCOPE _Pragma("float_control(precise, on)")
+#elif defined(__GNUC__)
+#define PAD_FP_PRECISE __attribute__((optimize("no-fast-math")))
+#define PAD_FP_PRECISE_SCOPE
+#else
+#define PAD_FP_PRECISE
+#define PAD_FP_PRECISE_SCOPE
+#endif
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// Type the sum of T is carried in: double for widened float, T otherwise.
+template <typename T>
+using widened_t = std::conditional_t<std::is_same_v<T, float>, double, T>;
+
+// A sum and the rounding error it has not absorbed yet.
+template <typename A>
+struct compensated {
+  A sum;
+  A comp;
+};
+
+// a + b with Neumaier's correction, also used to join the partial results
+// of threads and NUMA nodes for every method.
+template <typename A>
+PAD_FP_PRECISE compensated<A> join(const compensated<A>& a,
+                                   const compensated<A>& b) {
+  PAD_FP_PRECISE_SCOPE
+  const A t = a.sum + b.sum;
+  const A err = std::abs(a.sum) >= std::abs(b.sum) ? (a.sum - t) + b.sum
+                                                   : (b.sum - t) + a.sum;
+  return {t, a.comp + b.comp + err};
+}
+
+// Lane-wise Kahan over x[0, n): simd_width running sums, each with its own
+// compensation. The tail goes into the first lanes.
+template <typename T>
+PAD_FP_PRECISE compensated<T> kahan_sum(const T* x, index_type n) {
+  PAD_FP_PRECISE_SCOPE
+  simd_acc<T> s{}, c{};
+  const index_type blocks = n / simd_width;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = x + u * simd_width;
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      const T y = xu[i] - c[i];
+      const T t = s[i] + y;
+      c[i] = (t - s[i]) - y;
+      s[i] = t;
+    }
+  }
+  for (index_type i = 0; i < n - blocks * simd_width; ++i) {
+    const T y = x[blocks * simd_width + i] - c[i];
+    const T t = s[i] + y;
+    c[i] = (t - s[i]) - y;
+    s[i] = t;
+  }
+  compensated<T> r{0, 0};
+  // Kahan's c is the negated error
+  for (index_type i = 0; i < simd_width; ++i) r = join(r, {s[i], -c[i]});
+  return r;
+}
+
+// Lane-wise Neumaier over x[0, n), which unlike Kahan also keeps the error
+// when an element is larger than the running sum.
+template <typename T>
+PAD_FP_PRECISE compensated<T> neumaier_sum(const T* x, index_type n) {
+  PAD_FP_PRECISE_SCOPE
+  simd_acc<T> s{}, c{};
+  const index_type blocks = n / simd_width;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = x + u * simd_width;
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      const T t = s[i] + xu[i];
+      c[i] += std::abs(s[i]) >= std::abs(xu[i]) ? (s[i] - t) + xu[i]
+                                                : (xu[i] - t) + s[i];
+      s[i] = t;
+    }
+  }
+  compensated<T> r{0, 0};
+  for (index_type i = 0; i < simd_width; ++i) r = join(r, {s[i], c[i]});
+  for (index_type i = blocks * simd_width; i < n; ++i) {
+    r = join(r, {x[i], T{0}});
+  }
+  return r;
+}
+
+// Recursive halving down to pairwise_block elements, each summed with the
+// plain SIMD kernel. The error grows with log(n) instead of n.
+template <typename T>
+T pairwise_sum(const T* x, index_type n) {
+  if (n <= pairwise_block) return reduce_simd(x, n);
+  const index_type half = n / 2 / simd_width * simd_width;
+  return pairwise_sum(x, half) + pairwise_sum(x + half, n - half);
+}
+
+// Vertical sum of float in double lanes
+template <typename T>
+widened_t<T> widened_sum(const T* x, index_type n) {
+  using A = widened_t<T>;
+  simd_acc<A> acc{};
+  const index_type blocks = n / simd_width;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = x + u * simd_width;
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      acc[i] += static_cast<A>(xu[i]);
+    }
+  }
+  for (index_type i = blocks * simd_width; i < n; ++i) {
+    acc[0] += static_cast<A>(x[i]);
+  }
+  return reduce_horizontal(acc);
+}
+
+// x[0, n) summed with `method`, carried in widened_t<T> for every method so
+// that the parallel versions can join chunks of different methods alike.
+template <typename T>
+compensated<widened_t<T>> accurate_sum(exec::summation method,
+                                       const T* x,
+                                       index_type n) {
+  using A = widened_t<T>;
+  auto widen = [](const compensated<T>& c) {
+    return compensated<A>{static_cast<A>(c.sum), static_cast<A>(c.comp)};
+  };
+  switch (method) {
+    case exec::summation::kahan:
+      return widen(kahan_sum(x, n));
+    case exec::summation::neumaier:
+      return widen(neumaier_sum(x, n));
+    case exec::summation::pairwise:
+      return {static_cast<A>(pairwise_sum(x, n)), A{0}};
+    default:
+      return {widened_sum(x, n), A{0}};
+  }
+}
+
+// Final value of a compensated sum: the correction is added in last.
+template <typename T, typename A>
+T accurate_result(const compensated<A>& c) {
+  return static_cast<T>(c.sum + c.comp);
+}
+
+// tbb::parallel_reduce of accurate_sum over the whole vectors of x[0, n);
+// grain_size counts simd_width blocks. The tail is joined last.
+template <typename T, typename Partitioner>
+compensated<widened_t<T>> accurate_tbb(exec::summation method,
+                                       const T* x,
+                                       index_type n,
+                                       Partitioner& part,
+                                       int grain_size) {
+  using namespace oneapi::tbb;
+  using C = compensated<widened_t<T>>;
+  const index_type blocks = n / simd_width;
+  const C body = parallel_reduce(
+      blocked_range<index_type>(0, blocks, grain_size), C{0, 0},
+      [=](const blocked_range<index_type>& r, C acc) {
+        return join(acc, accurate_sum(method, x + r.begin() * simd_width,
+                                      (r.end() - r.begin()) * simd_width));
+      },
+      [](const C& lhs, const C& rhs) { return join(lhs, rhs); }, part);
+  return join(body, accurate_sum(method, x + blocks * simd_width,
+                                 n - blocks * simd_width));
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Sum of [first, last) on the calling thread with policy.method.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::accurate_policy<exec::simd_policy> policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  return detail::accurate_result<value_type>(
+      detail::accurate_sum(policy.method, detail::data(first), n));
+}
+
+// Sum of [first, last) with tbb::parallel_reduce and policy.method within
+// every chunk; the chunk sums are joined with Neumaier's correction.
+// grain_size counts simd_width blocks.
+template <typename Iter, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::accurate_policy<exec::tbb_policy> policy,
+    Iter first,
+    Iter last,
+    Partitioner& part,
+    int grain_size = 1) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  return detail::accurate_result<value_type>(detail::accurate_tbb(
+      policy.method, detail::data(first), n, part, grain_size));
+}
+
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::accurate_policy<exec::tbb_policy> policy,
+    Iter first,
+    Iter last) {
+  oneapi::tbb::auto_partitioner part;
+  return reduce(policy, first, last, part);
+}
+
+// Sum of [first, last) with one accurate tbb reduction per NUMA node, the
+// node sums joined in node order.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::accurate_policy<exec::numa_policy> policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  using C = detail::compensated<detail::widened_t<value_type>>;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  std::vector<C> partial(numa::node_count(), C{0, 0});
+  numa::for_each_node(n, [&](int node, index_type begin, index_type end) {
+    oneapi::tbb::static_partitioner part;
+    partial[node] =
+        detail::accurate_tbb(policy.method, x + begin, end - begin, part, 1);
+  });
+  C total{0, 0};
+  for (const C& p : partial) total = detail::join(total, p);
+  return detail::accurate_result<value_type>(total);
+}
+
+}  // namespace pad
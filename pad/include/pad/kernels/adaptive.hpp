@@ -0,0 +1,59 @@
+#pragma once
+
+#include <iterator>
+
+#include "pad/dispatch.hpp"
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/transform.hpp"
+
+namespace pad {
+
+namespace detail {
+// The path dispatch::choose picks for n elements of T. The calibration is
+// done with float; other types are weighed by their size in floats.
+template <typename T, typename F>
+decltype(auto) with_chosen_policy(dispatch::kernel k, index_type n, F&& f) {
+  const index_type floats =
+      static_cast<index_type>(n * sizeof(T) / sizeof(float));
+  const dispatch::decision d = dispatch::choose(k, floats);
+  switch (d.path) {
+    case dispatch::backend::omp:
+      return f(exec::omp_threads(d.threads));
+    case dispatch::backend::tbb:
+      return f(exec::tbb);
+    case dispatch::backend::numa:
+      return f(exec::numa);
+    default:
+      return f(exec::simd);
+  }
+}
+}  // namespace detail
+
+// Sum of [first, last) on the backend dispatch::choose predicts is fastest
+// for its size.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::adaptive_policy,
+                                                       Iter first,
+                                                       Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  return detail::with_chosen_policy<value_type>(
+      dispatch::kernel::reduce, std::distance(first, last),
+      [&](auto policy) -> value_type { return reduce(policy, first, last); });
+}
+
+// Y = a * X + Y on the backend dispatch::choose predicts is fastest for its
+// size.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::adaptive_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  detail::with_chosen_policy<value_type>(
+      dispatch::kernel::transform, std::distance(Xbegin, Xend),
+      [&](auto policy) { transform(policy, a, Xbegin, Xend, Ybegin); });
+}
+
+}  // namespace pad
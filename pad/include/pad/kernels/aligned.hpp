@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <omp.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/transform.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// The precondition of the assume_aligned overloads, asserted in debug builds
+template <typename T>
+bool line_aligned(const T* p) {
+  return reinterpret_cast<std::uintptr_t>(p) % cache_line == 0;
+}
+
+// The aligned kernels without the peel, for an x known to start on a
+// cache_line boundary, through the kernel table for float.
+template <typename T>
+void reduce_block_assumed(const T* x, index_type n, simd_acc<T>& acc) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().reduce_aligned_f32(x, n, acc);
+  } else {
+    reduce_vertical_aligned(x, n, acc);
+  }
+}
+
+template <typename Constant, typename T>
+void transform_block_assumed(Constant a, const T* x, T* y, index_type n) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_aligned_f32(a, x, y, n);
+  } else {
+    transform_simd_aligned(a, x, y, n);
+  }
+}
+
+// static_chunk in whole cache lines of T, so that every chunk of an aligned
+// range starts aligned. The last member also takes the partial line.
+template <typename T>
+void line_chunk(index_type n, int id, int team, index_type& begin,
+                index_type& end) {
+  constexpr index_type line = line_elements<T>;
+  static_chunk(n / line, id, team, begin, end);
+  begin *= line;
+  end = id == team - 1 ? n : end * line;
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Sum of an aligned [first, last) on the calling thread.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::assume_aligned_policy<exec::simd_policy>,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  assert(detail::line_aligned(detail::data(first)));
+  detail::simd_acc<value_type> acc{};
+  detail::reduce_block_assumed(detail::data(first), n, acc);
+  return detail::reduce_horizontal(acc);
+}
+
+// Sum of an aligned [first, last) on an OpenMP team, one line_chunk per
+// thread.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::assume_aligned_policy<exec::omp_policy> policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  value_type sum = 0;
+  if (n == 0) return sum;
+  const value_type* x = detail::data(first);
+  assert(detail::line_aligned(x));
+  const int threads = policy.policy.threads > 0 ? policy.policy.threads
+                                                : omp_get_max_threads();
+#pragma omp parallel num_threads(threads) reduction(+ : sum)
+  {
+    index_type begin, end;
+    detail::line_chunk<value_type>(n, omp_get_thread_num(),
+                                   omp_get_num_threads(), begin, end);
+    detail::simd_acc<value_type> acc{};
+    detail::reduce_block_assumed(x + begin, end - begin, acc);
+    sum += detail::reduce_horizontal(acc);
+  }
+  return sum;
+}
+
+// Sum of an aligned [first, last) with tbb::parallel_reduce over whole cache
+// lines; grain_size counts lines.
+template <typename Iter, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::assume_aligned_policy<exec::tbb_policy>,
+    Iter first,
+    Iter last,
+    Partitioner& part,
+    int grain_size = 1) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  using simd_value_type = detail::simd_acc<value_type>;
+  using namespace oneapi::tbb;
+  constexpr index_type line = detail::line_elements<value_type>;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  assert(detail::line_aligned(x));
+  const index_type lines = n / line;
+
+  simd_value_type simd_sum = parallel_reduce(
+      blocked_range<index_type>(0, lines, grain_size), simd_value_type{},
+      [=](const blocked_range<index_type>& r, simd_value_type simd_acc) {
+        detail::reduce_block_assumed(x + r.begin() * line,
+                                     (r.end() - r.begin()) * line, simd_acc);
+        return simd_acc;
+      },
+      [](simd_value_type lhs, const simd_value_type& rhs) {
+#pragma omp simd
+        for (index_type i = 0; i < simd_width; ++i) lhs[i] += rhs[i];
+        return lhs;
+      },
+      part);
+  detail::reduce_block_assumed(x + lines * line, n - lines * line, simd_sum);
+  return detail::reduce_horizontal(simd_sum);
+}
+
+// Y = a * X + Y on the calling thread, X and Y aligned.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::assume_aligned_policy<exec::simd_policy>,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  assert(detail::line_aligned(detail::data(Xbegin)));
+  assert(detail::line_aligned(detail::data(Ybegin)));
+  detail::transform_block_assumed(a, detail::data(Xbegin),
+                                  detail::data(Ybegin), n);
+}
+
+// Y = a * X + Y on an OpenMP team, one line_chunk per thread.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::assume_aligned_policy<exec::omp_policy> policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  assert(detail::line_aligned(x));
+  assert(detail::line_aligned(y));
+  using value_type = std::remove_cv_t<std::remove_pointer_t<decltype(x)>>;
+  const int threads = policy.policy.threads > 0 ? policy.policy.threads
+                                                : omp_get_max_threads();
+#pragma omp parallel num_threads(threads)
+  {
+    index_type begin, end;
+    detail::line_chunk<value_type>(n, omp_get_thread_num(),
+                                   omp_get_num_threads(), begin, end);
+    detail::transform_block_assumed(a, x + begin, y + begin, end - begin);
+  }
+}
+
+// Y = a * X + Y with tbb::parallel_for over whole cache lines; grain_size
+// counts lines.
+template <typename Constant, typename Iter, typename OutIter,
+          typename Partitioner>
+void transform(exec::assume_aligned_policy<exec::tbb_policy>,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               Partitioner& part,
+               int grain_size = 1) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  assert(detail::line_aligned(x));
+  assert(detail::line_aligned(y));
+  using value_type = std::remove_cv_t<std::remove_pointer_t<decltype(x)>>;
+  constexpr index_type line = detail::line_elements<value_type>;
+  const index_type lines = n / line;
+  detail::transform_tbb(lines, part, grain_size,
+                        [=](index_type begin, index_type m) {
+                          detail::transform_block_assumed(
+                              a, x + begin * line, y + begin * line, m * line);
+                        });
+  detail::transform_block_assumed(a, x + lines * line, y + lines * line,
+                                  n - lines * line);
+}
+
+}  // namespace pad
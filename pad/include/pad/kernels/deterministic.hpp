@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <omp.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/numa.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+inline index_type block_count(index_type n) {
+  return (n + deterministic_block - 1) / deterministic_block;
+}
+
+// Sum of block b of x[0, n), always with the same kernel and lane order.
+template <typename T>
+T block_sum(const T* x, index_type n, index_type b) {
+  const index_type begin = b * deterministic_block;
+  return reduce_simd(x + begin, std::min(deterministic_block, n - begin));
+}
+
+// Sum of p[0, m) in a fixed binary tree: neighbours first, then pairs of
+// pairs and so on. Overwrites p.
+template <typename T>
+T tree_sum(T* p, index_type m) {
+  if (m == 0) return T{0};
+  for (index_type stride = 1; stride < m; stride *= 2) {
+    for (index_type i = 0; i + stride < m; i += 2 * stride) {
+      p[i] += p[i + stride];
+    }
+  }
+  return p[0];
+}
+
+// tree_sum of the block sums of x[0, n); fill(partial) stores block_sum(b)
+// into partial[b] for every block, in any order and on any threads.
+template <typename T, typename Fill>
+T deterministic_sum(index_type n, Fill fill) {
+  std::vector<T> partial(block_count(n));
+  fill(partial.data());
+  return tree_sum(partial.data(), static_cast<index_type>(partial.size()));
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Reproducible sum of [first, last) on the calling thread. Bitwise equal to
+// the deterministic omp, tbb and numa sums of the same range.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::deterministic_policy<exec::simd_policy>,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  return detail::deterministic_sum<value_type>(n, [&](value_type* partial) {
+    for (index_type b = 0; b < detail::block_count(n); ++b) {
+      partial[b] = detail::block_sum(x, n, b);
+    }
+  });
+}
+
+// Reproducible sum of [first, last), the blocks spread over an OpenMP team
+// of policy.policy.threads threads (the default team size if 0).
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::deterministic_policy<exec::omp_policy> policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  const int threads = policy.policy.threads > 0 ? policy.policy.threads
+                                                : omp_get_max_threads();
+  return detail::deterministic_sum<value_type>(n, [&](value_type* partial) {
+    const index_type blocks = detail::block_count(n);
+#pragma omp parallel for schedule(static) num_threads(threads)
+    for (index_type b = 0; b < blocks; ++b) {
+      partial[b] = detail::block_sum(x, n, b);
+    }
+  });
+}
+
+// Reproducible sum of [first, last), the blocks spread by tbb::parallel_for
+// with any partitioner; grain_size counts blocks.
+template <typename Iter, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::deterministic_policy<exec::tbb_policy>,
+    Iter first,
+    Iter last,
+    Partitioner& part,
+    int grain_size = 1) {
+  using namespace oneapi::tbb;
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  return detail::deterministic_sum<value_type>(n, [&](value_type* partial) {
+    parallel_for(
+        blocked_range<index_type>(0, detail::block_count(n), grain_size),
+        [=](const blocked_range<index_type>& r) {
+          for (index_type b = r.begin(); b < r.end(); ++b) {
+            partial[b] = detail::block_sum(x, n, b);
+          }
+        },
+        part);
+  });
+}
+
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::deterministic_policy<exec::tbb_policy> policy,
+    Iter first,
+    Iter last) {
+  oneapi::tbb::auto_partitioner part;
+  return reduce(policy, first, last, part);
+}
+
+// Reproducible sum of [first, last), every NUMA node summing the blocks of
+// its share of the range in its own arena.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::deterministic_policy<exec::numa_policy>,
+    Iter first,
+    Iter last) {
+  using namespace oneapi::tbb;
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  return detail::deterministic_sum<value_type>(n, [&](value_type* partial) {
+    numa::for_each_node(
+        detail::block_count(n), [=](int, index_type begin, index_type end) {
+          static_partitioner part;
+          parallel_for(
+              blocked_range<index_type>(begin, end),
+              [=](const blocked_range<index_type>& r) {
+                for (index_type b = r.begin(); b < r.end(); ++b) {
+                  partial[b] = detail::block_sum(x, n, b);
+                }
+              },
+              part);
+        });
+  });
+}
+
+}  // namespace pad
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+
+// Binary min and max as function objects, for reduce(..., identity, op).
+struct minimum {
+  template <typename T>
+  constexpr T operator()(T a, T b) const {
+    return b < a ? b : a;
+  }
+};
+
+struct maximum {
+  template <typename T>
+  constexpr T operator()(T a, T b) const {
+    return a < b ? b : a;
+  }
+};
+
+// Identity element of the operators above and of std::plus / multiplies.
+template <typename T>
+constexpr T identity(std::plus<>) {
+  return T{0};
+}
+
+template <typename T>
+constexpr T identity(std::multiplies<>) {
+  return T{1};
+}
+
+template <typename T>
+constexpr T identity(minimum) {
+  return std::numeric_limits<T>::has_infinity
+             ? std::numeric_limits<T>::infinity()
+             : std::numeric_limits<T>::max();
+}
+
+template <typename T>
+constexpr T identity(maximum) {
+  return std::numeric_limits<T>::has_infinity
+             ? -std::numeric_limits<T>::infinity()
+             : std::numeric_limits<T>::lowest();
+}
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// Bytes of one vector register at an ISA level. The folds below are built
+// for each level with target attributes and run at the level isa::kernels()
+// picked at startup, whatever -march the caller is built with.
+constexpr std::size_t vector_bytes(isa::level isa) {
+  return isa == isa::level::avx512f ? 64 : isa == isa::level::avx2 ? 32 : 16;
+}
+
+// Elements of T in one vector register of Bytes: 8 floats or 4 doubles with
+// AVX2, 32 uint8_t with AVX2, and so on.
+template <typename T, std::size_t Bytes>
+constexpr index_type vector_lanes = static_cast<index_type>(Bytes / sizeof(T));
+
+template <typename T, std::size_t Bytes>
+using lane_acc = std::array<T, vector_lanes<T, Bytes>>;
+
+// acc[i] = op(acc[i], x[k]) for every k of x[0, n) with k % lanes == i.
+template <std::size_t Bytes, typename T, typename BinaryOp>
+void fold_lanes(const T* x,
+                index_type n,
+                lane_acc<T, Bytes>& acc,
+                BinaryOp op) {
+  constexpr index_type lanes = vector_lanes<T, Bytes>;
+  const index_type blocks = n / lanes;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = x + u * lanes;
+#pragma omp simd
+    for (index_type i = 0; i < lanes; ++i) {
+      acc[i] = op(acc[i], xu[i]);
+    }
+  }
+  for (index_type i = 0; i < n - blocks * lanes; ++i) {
+    acc[i] = op(acc[i], x[blocks * lanes + i]);
+  }
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// fold_lanes and op inlined into one function built for AVX2 or AVX-512F
+template <std::size_t Bytes, typename T, typename BinaryOp>
+__attribute__((target("avx2,fma"), flatten)) void fold_lanes_avx2(
+    const T* x,
+    index_type n,
+    lane_acc<T, Bytes>& acc,
+    BinaryOp op) {
+  fold_lanes<Bytes>(x, n, acc, op);
+}
+
+template <std::size_t Bytes, typename T, typename BinaryOp>
+__attribute__((target("avx512f,avx2,fma"), flatten)) void fold_lanes_avx512(
+    const T* x,
+    index_type n,
+    lane_acc<T, Bytes>& acc,
+    BinaryOp op) {
+  fold_lanes<Bytes>(x, n, acc, op);
+}
+#endif
+
+// fold_lanes built for the ISA level with Bytes wide vectors
+template <std::size_t Bytes, typename T, typename BinaryOp>
+void fold_vertical(const T* x,
+                   index_type n,
+                   lane_acc<T, Bytes>& acc,
+                   BinaryOp op) {
+#if defined(__x86_64__) && defined(__GNUC__)
+  if constexpr (Bytes == 64) {
+    fold_lanes_avx512<Bytes>(x, n, acc, op);
+  } else if constexpr (Bytes == 32) {
+    fold_lanes_avx2<Bytes>(x, n, acc, op);
+  } else {
+    fold_lanes<Bytes>(x, n, acc, op);
+  }
+#else
+  fold_lanes<Bytes>(x, n, acc, op);
+#endif
+}
+
+// Combines the lanes of `acc` with op as a log2(lanes) tree, like
+// reduce_tree does for +.
+template <std::size_t Bytes, typename T, typename BinaryOp>
+T fold_horizontal(lane_acc<T, Bytes> acc, BinaryOp op) {
+  for (index_type w = vector_lanes<T, Bytes> / 2; w > 0; w /= 2) {
+#pragma omp simd
+    for (index_type i = 0; i < w; ++i) {
+      acc[i] = op(acc[i], acc[i + w]);
+    }
+  }
+  return acc[0];
+}
+
+template <std::size_t Bytes, typename T>
+lane_acc<T, Bytes> lanes_of(T identity) {
+  lane_acc<T, Bytes> acc;
+  acc.fill(identity);
+  return acc;
+}
+
+// op-reduction of x[0, n) on the calling thread
+template <std::size_t Bytes, typename T, typename BinaryOp>
+T fold_simd(const T* x, index_type n, T identity, BinaryOp op) {
+  lane_acc<T, Bytes> acc = lanes_of<Bytes>(identity);
+  fold_vertical<Bytes>(x, n, acc, op);
+  return fold_horizontal<Bytes>(acc, op);
+}
+
+// tbb::parallel_reduce over the whole vectors of x[0, n) with op; the tail
+// is folded in last. grain_size counts vectors.
+template <std::size_t Bytes, typename T, typename BinaryOp,
+          typename Partitioner>
+T fold_tbb(const T* x,
+           index_type n,
+           T identity,
+           BinaryOp op,
+           Partitioner& part,
+           int grain_size) {
+  using namespace oneapi::tbb;
+  using acc_type = lane_acc<T, Bytes>;
+  constexpr index_type lanes = vector_lanes<T, Bytes>;
+  const index_type blocks = n / lanes;
+  acc_type acc = parallel_reduce(
+      blocked_range<index_type>(0, blocks, grain_size),
+      lanes_of<Bytes>(identity),
+      [x, op](const blocked_range<index_type>& r, acc_type acc) {
+        fold_vertical<Bytes>(x + r.begin() * lanes,
+                             (r.end() - r.begin()) * lanes, acc, op);
+        return acc;
+      },
+      [op](acc_type lhs, const acc_type& rhs) {
+#pragma omp simd
+        for (index_type i = 0; i < lanes; ++i) lhs[i] = op(lhs[i], rhs[i]);
+        return lhs;
+      },
+      part);
+  fold_vertical<Bytes>(x + blocks * lanes, n - blocks * lanes, acc, op);
+  return fold_horizontal<Bytes>(acc, op);
+}
+
+// f(std::integral_constant<std::size_t, Bytes>{}) for the vector width of
+// the level isa::kernels() runs at
+template <typename F>
+decltype(auto) with_vector_bytes(F&& f) {
+  switch (vector_bytes(isa::kernels().isa)) {
+    case 64:
+      return f(std::integral_constant<std::size_t, 64>{});
+    case 32:
+      return f(std::integral_constant<std::size_t, 32>{});
+    default:
+      return f(std::integral_constant<std::size_t, 16>{});
+  }
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// op-reduction of [first, last) on the calling thread, one vector register
+// wide accumulator at the ISA level picked at startup: identity if the range
+// is empty. op must be associative and commutative; identity must satisfy
+// op(identity, x) == x.
+template <typename Iter, typename BinaryOp>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::simd_policy,
+    Iter first,
+    Iter last,
+    typename std::iterator_traits<Iter>::value_type identity,
+    BinaryOp op) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  static_assert(std::is_arithmetic_v<value_type>,
+                "arithmetic value types only");
+  if (first == last) return identity;
+  const value_type* x = detail::data(first);
+  const index_type n = std::distance(first, last);
+  return detail::with_vector_bytes([&](auto bytes) {
+    return detail::fold_simd<decltype(bytes)::value>(x, n, identity, op);
+  });
+}
+
+// op-reduction of [first, last) with tbb::parallel_reduce, one
+// vector_lanes<T, Bytes> wide accumulator per task; grain_size counts
+// vectors of the ISA level picked at startup.
+template <typename Iter, typename BinaryOp, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::tbb_policy,
+    Iter first,
+    Iter last,
+    typename std::iterator_traits<Iter>::value_type identity,
+    BinaryOp op,
+    Partitioner& part,
+    int grain_size = 1) {
+  static_assert(
+      std::is_arithmetic_v<typename std::iterator_traits<Iter>::value_type>,
+      "arithmetic value types only");
+  if (first == last) return identity;
+  const auto* x = detail::data(first);
+  const index_type n = std::distance(first, last);
+  return detail::with_vector_bytes([&](auto bytes) {
+    return detail::fold_tbb<decltype(bytes)::value>(x, n, identity, op, part,
+                                                    grain_size);
+  });
+}
+
+template <typename Iter, typename BinaryOp>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::tbb_policy policy,
+    Iter first,
+    Iter last,
+    typename std::iterator_traits<Iter>::value_type identity,
+    BinaryOp op) {
+  oneapi::tbb::auto_partitioner part;
+  return reduce(policy, first, last, identity, op, part);
+}
+
+}  // namespace pad
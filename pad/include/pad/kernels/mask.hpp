@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// Sliding window for tail masks: the simd_width entries starting at
+// tail_mask_table + simd_width - r have exactly the first r lanes set.
+static_assert(simd_width == 8, "tail_mask_table holds 8 lanes");
+alignas(64) inline constexpr std::int32_t tail_mask_table[2 * simd_width] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+#if defined(__AVX2__)
+inline __m256i tail_mask_ps(index_type r) {
+  return _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(tail_mask_table + simd_width - r));
+}
+#endif
+
+// acc[0, r) += x[0, r) for 0 <= r < simd_width, without branching on r.
+// Lanes at or beyond r are read and rewritten unchanged; x is not read there.
+template <typename T>
+void masked_add(const T* x, index_type r, T* acc) {
+#if defined(__AVX2__)
+  if constexpr (std::is_same_v<T, float>) {
+    const __m256i mask = tail_mask_ps(r);
+    const __m256 v = _mm256_maskload_ps(x, mask);
+    _mm256_storeu_ps(acc, _mm256_add_ps(_mm256_loadu_ps(acc), v));
+    return;
+  }
+#endif
+#pragma omp simd
+  for (index_type i = 0; i < r; ++i) {
+    acc[i] += x[i];
+  }
+}
+
+// y[0, r) = a * x[0, r) + y[0, r) for 0 <= r < simd_width, without branching
+// on r. Nothing at or beyond r is read or written.
+template <typename T>
+void masked_axpy(T a, const T* x, T* y, index_type r) {
+#if defined(__AVX2__)
+  if constexpr (std::is_same_v<T, float>) {
+    const __m256i mask = tail_mask_ps(r);
+    const __m256 vx = _mm256_maskload_ps(x, mask);
+    const __m256 vy = _mm256_maskload_ps(y, mask);
+    const __m256 ax = _mm256_mul_ps(_mm256_set1_ps(a), vx);
+    _mm256_maskstore_ps(y, mask, _mm256_add_ps(ax, vy));
+    return;
+  }
+#endif
+#pragma omp simd
+  for (index_type i = 0; i < r; ++i) {
+    y[i] = a * x[i] + y[i];
+  }
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+}  // namespace pad
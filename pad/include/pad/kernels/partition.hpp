@@ -0,0 +1,121 @@
+#pragma once
+
+#include <numeric>
+
+#include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/task_arena.h>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/topology.hpp"
+#include "pad/tuning.hpp"
+
+namespace pad {
+
+// Cache a cache_partitioner sizes its chunks for.
+enum class cache_level { l2 = 2, l3 = 3 };
+
+// Partitioner for the tbb_policy kernels that splits a range into chunks
+// sized to a fraction `fill` of the per-core share of an L2 or L3 cache,
+// over all arrays the kernel streams through. Chunks are whole multiples of
+// cache_unit<T> elements and, but for the first and last, start on a cache
+// line boundary of the array written (of the input for a reduction), so
+// that no two chunks write to the same line. grain_size still bounds the
+// chunk from below.
+class cache_partitioner {
+ public:
+  explicit cache_partitioner(cache_level level = cache_level::l2,
+                             double fill = 0.5)
+      : level_(level),
+        bytes_(static_cast<index_type>(
+            fill * topology::cache_bytes_per_core(static_cast<int>(level)))) {}
+
+  cache_level level() const { return level_; }
+
+  // Elements of T per chunk when `streams` arrays of T are touched per
+  // element, rounded down to whole cache_unit<T>, at least one unit.
+  template <typename T>
+  index_type chunk(int streams) const;
+
+ private:
+  cache_level level_;
+  index_type bytes_;
+};
+
+// Smallest number of elements that fills both whole vectors and whole cache
+// lines.
+template <typename T>
+inline constexpr index_type cache_unit =
+    std::lcm(simd_width, detail::line_elements<T>);
+
+template <typename T>
+index_type cache_partitioner::chunk(int streams) const {
+  const index_type stream_bytes =
+      static_cast<index_type>(sizeof(T)) * (streams > 0 ? streams : 1);
+  const index_type elements = bytes_ / stream_bytes;
+  const index_type units = elements / cache_unit<T>;
+  return (units > 0 ? units : 1) * cache_unit<T>;
+}
+
+namespace detail {
+// Calls f(partitioner, grain_size) with the (partitioner, grain) pad-tune-tbb
+// found fastest for `kernel` over n elements at the concurrency of the
+// current arena, or with an auto_partitioner and grain 1 without tuning.
+// Affinity partitioners are kept per thread and kernel so that their
+// affinity hints carry over from one call to the next.
+template <tuning::tbb_kernel Kernel, typename F>
+decltype(auto) with_tuned_partitioner(index_type n, F&& f) {
+  using namespace oneapi::tbb;
+  const tuning::tbb_choice* c = tuning::tbb_lookup(
+      Kernel, n, this_task_arena::max_concurrency());
+  const int grain_size = c != nullptr ? c->grain_size : 1;
+  switch (c != nullptr ? c->part : tuning::partitioner::automatic) {
+    case tuning::partitioner::simple: {
+      simple_partitioner part;
+      return f(part, grain_size);
+    }
+    case tuning::partitioner::static_: {
+      static_partitioner part;
+      return f(part, grain_size);
+    }
+    case tuning::partitioner::affinity: {
+      thread_local affinity_partitioner part;
+      return f(part, grain_size);
+    }
+    default: {
+      auto_partitioner part;
+      return f(part, grain_size);
+    }
+  }
+}
+
+// tbb::parallel_for or parallel_reduce split of x[0, n) for a
+// cache_partitioner: the head up to the first cache line boundary of x, then
+// `units` blocks of cache_unit<T> elements, then the tail. The units are
+// handed out with a simple_partitioner `grain` units at a time.
+template <typename T>
+struct cache_split {
+  index_type head;
+  index_type units;
+  index_type tail;
+  index_type grain;
+};
+
+template <typename T>
+cache_split<T> split_for(const cache_partitioner& part,
+                         const T* x,
+                         index_type n,
+                         int streams,
+                         index_type min_elements) {
+  constexpr index_type unit = cache_unit<T>;
+  cache_split<T> s;
+  s.head = peel_count(x, n);
+  s.units = (n - s.head) / unit;
+  s.tail = n - s.head - s.units * unit;
+  index_type chunk = part.chunk<T>(streams);
+  if (chunk < min_elements) chunk = (min_elements + unit - 1) / unit * unit;
+  s.grain = chunk / unit;
+  return s;
+}
+}  // namespace detail
+
+}  // namespace pad
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+// The kernels are compiled once per ISA level into the same binary (see
+// src/isa_kernels.cpp). Each build puts its instantiations into its own
+// inline namespace so they cannot be merged at link time.
+#ifndef PAD_ISA_NAMESPACE
+#define PAD_ISA_NAMESPACE baseline
+#endif
+
+namespace pad {
+
+using index_type = std::ptrdiff_t;
+
+namespace ws {
+class pool;
+}
+
+// Width of the vertical accumulators used by the SIMD kernels, in elements.
+constexpr index_type simd_width = 8;
+
+// Largest block the pairwise summation adds with the plain SIMD kernel.
+constexpr index_type pairwise_block = 1024;
+
+// Elements per block of the deterministic reductions. Fixed, so that the
+// blocks, and the tree their sums are added in, depend on the size only.
+constexpr index_type deterministic_block = index_type{1} << 12;
+
+// Alignment the aligned kernel paths peel up to, in bytes: one cache line,
+// which is also one AVX-512 vector.
+constexpr std::size_t cache_line = 64;
+
+// Execution tags selecting a kernel path, in the spirit of std::execution.
+namespace exec {
+struct simd_policy {};  // single thread, vectorized
+struct tbb_policy {};   // oneTBB parallel_for / parallel_reduce
+
+// OpenMP team, vectorized per thread; `threads` members, or the default
+// team size when 0. Make one of a given size with exec::omp_threads(n).
+struct omp_policy {
+  int threads = 0;
+};
+
+// One tbb::task_arena per NUMA node (see pad/numa.hpp), each reducing or
+// transforming one contiguous, schedule(static)-like share of the range.
+struct numa_policy {};
+
+// serial simd, omp with some number of threads, tbb or numa, whichever the
+// cost model calibrated at startup predicts is fastest for the size of the
+// call (see pad/dispatch.hpp).
+struct adaptive_policy {};
+
+// pad's own work-stealing pool (see pad/ws/pool.hpp) in place of TBB. Make
+// one with exec::on(pool).
+struct pool_policy {
+  ws::pool* pool;
+};
+
+// Single thread with the kernel of the compile-time grid that pad-tune found
+// fastest for the size class of the call (see pad/tuning.hpp); the simd path
+// when there is no tuning for it.
+struct tuned_policy {};
+
+// Single thread in three phases: a masked prologue up to the first element
+// of the input on a cache_line boundary, an aligned-load main loop and a
+// masked epilogue.
+struct aligned_simd_policy {};
+
+// simd, omp or tbb on ranges the caller guarantees to start on a cache_line
+// boundary (X, and Y for transform), e.g. containers of aligned_allocator:
+// no peeling, aligned loads throughout and parallel chunks in whole cache
+// lines. Debug builds assert the alignment. Make one with
+// exec::assume_aligned(exec::tbb).
+template <typename Policy>
+struct assume_aligned_policy {
+  Policy policy;
+};
+
+template <typename Policy>
+constexpr assume_aligned_policy<Policy> assume_aligned(Policy policy) {
+  return {policy};
+}
+
+// Single thread with Unroll independent simd_width accumulators, so that
+// consecutive vector adds do not wait on each other's latency.
+template <int Unroll>
+struct unrolled_simd_policy {
+  static_assert(Unroll >= 1, "at least one accumulator");
+  static constexpr int unroll = Unroll;
+};
+
+// One of the policies above, simd or tbb, with software prefetches for X
+// and Y issued `distance` elements ahead of the current position. Make one
+// with exec::prefetch(exec::simd, distance).
+template <typename Policy>
+struct prefetch_policy {
+  index_type distance;
+};
+
+template <typename Policy>
+constexpr prefetch_policy<Policy> prefetch(Policy, index_type distance) {
+  return {distance};
+}
+
+// How the transform kernels write their output. non_temporal uses streaming
+// stores that bypass the caches and skip the read-for-ownership of every
+// written line; automatic does so only when the data a call touches does not
+// fit in the last-level cache (see pad/topology.hpp).
+enum class store_hint { temporal, non_temporal, automatic };
+
+inline const char* name(store_hint hint) {
+  switch (hint) {
+    case store_hint::temporal:
+      return "temporal";
+    case store_hint::non_temporal:
+      return "non_temporal";
+    default:
+      return "automatic";
+  }
+}
+
+// How the accurate reductions keep rounding errors down when summing float:
+// kahan and neumaier carry a compensation term per SIMD lane, pairwise
+// splits the input in halves down to blocks of pairwise_block elements,
+// widened accumulates float in double.
+enum class summation { kahan, neumaier, pairwise, widened };
+
+inline const char* name(summation method) {
+  switch (method) {
+    case summation::kahan:
+      return "kahan";
+    case summation::neumaier:
+      return "neumaier";
+    case summation::pairwise:
+      return "pairwise";
+    default:
+      return "widened";
+  }
+}
+
+// simd, tbb or numa reduction with one of the summation methods. Make one
+// with exec::accurate(exec::tbb, summation::neumaier).
+template <typename Policy>
+struct accurate_policy {
+  summation method;
+};
+
+template <typename Policy>
+constexpr accurate_policy<Policy> accurate(Policy, summation method) {
+  return {method};
+}
+
+// simd, omp, tbb or numa policy for a reduction that sums fixed blocks of
+// deterministic_block elements and adds the block sums in a fixed binary
+// tree. The result is then bitwise the same for all four, whatever the
+// thread count, partitioner or order of completion. Make one with
+// exec::deterministic(exec::tbb); the wrapped policy keeps its settings, as
+// the thread count of exec::deterministic(exec::omp_threads(n)).
+template <typename Policy>
+struct deterministic_policy {
+  Policy policy;
+};
+
+template <typename Policy>
+constexpr deterministic_policy<Policy> deterministic(Policy policy) {
+  return {policy};
+}
+
+// simd or tbb policy with a store hint. Make one with
+// exec::stores(exec::tbb, exec::store_hint::non_temporal).
+template <typename Policy>
+struct store_policy {
+  store_hint hint;
+};
+
+template <typename Policy>
+constexpr store_policy<Policy> stores(Policy, store_hint hint) {
+  return {hint};
+}
+
+inline constexpr simd_policy simd{};
+inline constexpr omp_policy omp{};
+inline constexpr tbb_policy tbb{};
+inline constexpr aligned_simd_policy simd_aligned{};
+inline constexpr tuned_policy tuned{};
+inline constexpr numa_policy numa{};
+inline constexpr adaptive_policy adaptive{};
+template <int Unroll>
+inline constexpr unrolled_simd_policy<Unroll> simd_unroll{};
+
+constexpr omp_policy omp_threads(int threads) {
+  return {threads};
+}
+
+inline pool_policy on(ws::pool& pool) {
+  return {&pool};
+}
+}  // namespace exec
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// The kernels work on contiguous ranges only; turn an iterator into the
+// pointer it refers to. Only call this for non-empty ranges.
+template <typename Iter>
+auto data(Iter it) {
+  return std::addressof(*it);
+}
+
+// Whether float kernels go through the table picked by pad::isa at startup.
+// Off inside the per-ISA builds, which provide that table.
+#if defined(PAD_ISA_BUILD)
+inline constexpr bool isa_dispatch = false;
+#else
+inline constexpr bool isa_dispatch = true;
+#endif
+
+// Elements per cache line; the prefetching kernels issue one prefetch per
+// line and stream.
+template <typename T>
+inline constexpr index_type line_elements = cache_line / sizeof(T);
+
+// Number of leading elements of x[0, n) before the first one that sits on a
+// cache_line boundary. x must be aligned to alignof(T).
+template <typename T>
+index_type peel_count(const T* x, index_type n) {
+  const auto misalign = reinterpret_cast<std::uintptr_t>(x) % cache_line;
+  const index_type head =
+      misalign == 0 ? 0 : (cache_line - misalign) / sizeof(T);
+  return head < n ? head : n;
+}
+
+// Contiguous chunk [begin, end) of n elements owned by member `id` of a team
+// of `team` threads, matching schedule(static) without a chunk size.
+inline void static_chunk(index_type n, int id, int team, index_type& begin,
+                         index_type& end) {
+  const index_type part = n / team;
+  const index_type rest = n % team;
+  begin = id * part + (id < rest ? id : rest);
+  end = begin + part + (id < rest ? 1 : 0);
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+}  // namespace pad
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE3__)
+#include <immintrin.h>
+#endif
+
+#include <omp.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/mask.hpp"
+#include "pad/kernels/partition.hpp"
+#include "pad/kernels/policy.hpp"
+#include "pad/numa.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+template <typename T>
+using simd_acc = std::array<T, simd_width>;
+
+// Lanes of the accumulator inside the reduce kernels of this build: one
+// 512-bit register of T where the build has AVX-512F, simd_width otherwise.
+// The kernels fold it into the simd_width wide simd_acc they are given.
+#if defined(__AVX512F__)
+template <typename T>
+constexpr index_type acc_width =
+    std::max<index_type>(simd_width, 64 / sizeof(T));
+#else
+template <typename T>
+constexpr index_type acc_width = simd_width;
+#endif
+
+// acc[i] += wide[k * simd_width + i] for every k
+template <typename T, std::size_t W>
+void fold_wide(const std::array<T, W>& wide, simd_acc<T>& acc) {
+  for (std::size_t k = 0; k < W; k += simd_width) {
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      acc[i] += wide[k + i];
+    }
+  }
+}
+
+// Adds the whole acc_width<T> vectors of x[0, n) into `acc` through an
+// acc_width<T> wide accumulator and returns how many elements that was.
+// Nothing where acc_width<T> is simd_width.
+template <bool Aligned, typename T>
+index_type reduce_wide(const T* x, index_type n, simd_acc<T>& acc) {
+  constexpr index_type width = acc_width<T>;
+  if constexpr (width == simd_width) {
+    return 0;
+  } else {
+    const index_type blocks = n / width;
+    if (blocks == 0) return 0;
+    const T* xa = Aligned ? static_cast<const T*>(
+                                __builtin_assume_aligned(x, cache_line))
+                          : x;
+    std::array<T, width> wide{};
+    for (index_type u = 0; u < blocks; ++u) {
+      const T* xu = xa + u * width;
+#pragma omp simd
+      for (index_type i = 0; i < width; ++i) {
+        wide[i] += xu[i];
+      }
+    }
+    fold_wide(wide, acc);
+    return blocks * width;
+  }
+}
+
+// Adds x[0, n) into the simd_width wide vertical accumulator `acc`. The main
+// loop only touches whole vectors (of acc_width<T>, then simd_width); the
+// n % simd_width trailing elements are folded in by a single masked add.
+template <typename T>
+void reduce_vertical(const T* x, index_type n, simd_acc<T>& acc) {
+  const index_type wide = reduce_wide<false>(x, n, acc);
+  x += wide;
+  n -= wide;
+  const index_type blocks = n / simd_width;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = x + u * simd_width;
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      acc[i] += xu[i];
+    }
+  }
+  masked_add(x + blocks * simd_width, n - blocks * simd_width, acc.data());
+}
+
+// reduce_vertical for an x that starts on a cache_line boundary, so that
+// every vector load of the main loop is aligned and never splits a line.
+template <typename T>
+void reduce_vertical_aligned(const T* x, index_type n, simd_acc<T>& acc) {
+  const index_type wide = reduce_wide<true>(x, n, acc);
+  const T* xa = static_cast<const T*>(
+      __builtin_assume_aligned(x + wide, cache_line));
+  n -= wide;
+  const index_type blocks = n / simd_width;
+  for (index_type u = 0; u < blocks; ++u) {
+    const T* xu = xa + u * simd_width;
+#pragma omp simd aligned(xu : simd_width * sizeof(T))
+    for (index_type i = 0; i < simd_width; ++i) {
+      acc[i] += xu[i];
+    }
+  }
+  masked_add(xa + blocks * simd_width, n - blocks * simd_width, acc.data());
+}
+
+// reduce_vertical with a read prefetch `distance` elements ahead once per
+// cache line. The last `distance` elements would prefetch past the end of the
+// range and are added without.
+template <typename T>
+void reduce_vertical_prefetch(const T* x,
+                              index_type n,
+                              simd_acc<T>& acc,
+                              index_type distance) {
+  constexpr index_type line = line_elements<T>;
+  constexpr index_type width = acc_width<T>;
+  static_assert(line % width == 0, "a cache line holds whole vectors");
+  const index_type lines = distance > 0 && distance < n
+                               ? (n - distance) / line
+                               : 0;
+  std::array<T, width> wide{};
+  for (index_type l = 0; l < lines; ++l) {
+    const T* xl = x + l * line;
+    __builtin_prefetch(xl + distance, 0, 3);
+    for (index_type u = 0; u < line; u += width) {
+#pragma omp simd
+      for (index_type i = 0; i < width; ++i) {
+        wide[i] += xl[u + i];
+      }
+    }
+  }
+  fold_wide(wide, acc);
+  reduce_vertical(x + lines * line, n - lines * line, acc);
+}
+
+template <typename T, std::size_t... K>
+void add_blocks(const T* x, simd_acc<T>* part, std::index_sequence<K...>) {
+  (
+      [&](simd_acc<T>& acc, const T* xk) {
+#pragma omp simd
+        for (index_type i = 0; i < simd_width; ++i) {
+          acc[i] += xk[i];
+        }
+      }(part[K], x + K * simd_width),
+      ...);
+}
+
+// Like reduce_vertical, but the main loop spreads consecutive vectors over
+// Unroll accumulators to break the loop-carried dependency on a single one.
+// They are combined into `acc` before the remaining elements are added.
+template <int Unroll, typename T>
+void reduce_vertical_unrolled(const T* x, index_type n, simd_acc<T>& acc) {
+  constexpr index_type step = Unroll * simd_width;
+  const index_type blocks = n / step;
+  simd_acc<T> part[Unroll] = {};
+  for (index_type u = 0; u < blocks; ++u) {
+    add_blocks(x + u * step, part, std::make_index_sequence<Unroll>{});
+  }
+  for (int k = 0; k < Unroll; ++k) {
+#pragma omp simd
+    for (index_type i = 0; i < simd_width; ++i) {
+      acc[i] += part[k][i];
+    }
+  }
+  reduce_vertical(x + blocks * step, n - blocks * step, acc);
+}
+
+// reduce_vertical through the kernel table picked at startup for float, the
+// baseline build of it otherwise.
+template <typename T>
+void reduce_block(const T* x, index_type n, simd_acc<T>& acc) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().reduce_f32(x, n, acc);
+  } else {
+    reduce_vertical(x, n, acc);
+  }
+}
+
+// Masked prologue up to the first cache line boundary of x, then the
+// aligned kernel, through the kernel table for float.
+template <typename T>
+void reduce_block_aligned(const T* x, index_type n, simd_acc<T>& acc) {
+  const index_type head = peel_count(x, n);
+  reduce_vertical(x, head, acc);
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().reduce_aligned_f32(x + head, n - head, acc);
+  } else {
+    reduce_vertical_aligned(x + head, n - head, acc);
+  }
+}
+
+template <typename T>
+void reduce_block_prefetch(const T* x,
+                           index_type n,
+                           simd_acc<T>& acc,
+                           index_type distance) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().reduce_prefetch_f32(x, n, acc, distance);
+  } else {
+    reduce_vertical_prefetch(x, n, acc, distance);
+  }
+}
+
+template <typename T>
+T reduce_horizontal(const simd_acc<T>& acc) {
+  T sum = 0;
+#pragma omp simd reduction(+ : sum)
+  for (index_type i = 0; i < simd_width; ++i) {
+    sum += acc[i];
+  }
+  return sum;
+}
+
+// Horizontal sum of `acc` as a log2(simd_width) shuffle tree: each level adds
+// the upper half of the live lanes onto the lower half.
+template <typename T>
+T reduce_tree(const simd_acc<T>& acc) {
+#if defined(__SSE3__)
+  if constexpr (std::is_same_v<T, float>) {
+    __m128 s = _mm_add_ps(_mm_loadu_ps(acc.data()),
+                          _mm_loadu_ps(acc.data() + 4));  // 8 -> 4
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));               // 4 -> 2
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));                // 2 -> 1
+    return _mm_cvtss_f32(s);
+  }
+#endif
+  simd_acc<T> v = acc;
+  for (index_type w = simd_width / 2; w > 0; w /= 2) {
+#pragma omp simd
+    for (index_type i = 0; i < w; ++i) {
+      v[i] += v[i + w];
+    }
+  }
+  return v[0];
+}
+
+template <typename T>
+T reduce_simd(const T* x, index_type n) {
+  simd_acc<T> acc{};
+  reduce_block(x, n, acc);
+  return reduce_horizontal(acc);
+}
+
+// tbb::parallel_reduce over the whole vectors of x[0, n), `block` adding
+// each subrange into a simd_acc; the tail is added with reduce_block.
+template <typename T, typename Partitioner, typename Block>
+T reduce_tbb(const T* x,
+             index_type n,
+             Partitioner& part,
+             int grain_size,
+             Block block) {
+  using simd_value_type = simd_acc<T>;
+  using namespace oneapi::tbb;
+  const index_type blocks = n / simd_width;
+
+  simd_value_type simd_sum = parallel_reduce(
+      blocked_range<index_type>(0, blocks, grain_size), simd_value_type{},
+      [x, block](const blocked_range<index_type>& r, simd_value_type simd_acc) {
+        block(x + r.begin() * simd_width, (r.end() - r.begin()) * simd_width,
+              simd_acc);
+        return simd_acc;
+      },
+      [](simd_value_type lhs, const simd_value_type& rhs) {
+#pragma omp simd
+        for (index_type i = 0; i < simd_width; ++i) lhs[i] += rhs[i];
+        return lhs;
+      },
+      part);
+  reduce_block(x + blocks * simd_width, n - blocks * simd_width, simd_sum);
+  return reduce_horizontal(simd_sum);
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Sum of [first, last) on the calling thread.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::simd_policy,
+                                                       Iter first,
+                                                       Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  return detail::reduce_simd(detail::data(first), n);
+}
+
+// Sum of [first, last) on the calling thread, peeling the head of the range
+// so that the main loop only issues aligned loads.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::aligned_simd_policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  detail::simd_acc<value_type> acc{};
+  detail::reduce_block_aligned(detail::data(first), n, acc);
+  return detail::reduce_horizontal(acc);
+}
+
+// Sum of [first, last) on the calling thread with Unroll accumulators.
+template <int Unroll, typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::unrolled_simd_policy<Unroll>,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  detail::simd_acc<value_type> acc{};
+  detail::reduce_vertical_unrolled<Unroll>(detail::data(first), n, acc);
+  return detail::reduce_horizontal(acc);
+}
+
+// Writes the sum of every block of K * simd_width consecutive elements of
+// [first, last) to out, the last block possibly shorter, and returns the end
+// of the output. Each block is accumulated vertically and reduced with one
+// shuffle tree, instead of one horizontal add per vector.
+template <int K, typename Iter, typename OutIter>
+OutIter reduce_blocks(exec::simd_policy, Iter first, Iter last, OutIter out) {
+  static_assert(K > 0, "a block holds at least one vector");
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  constexpr index_type block = K * simd_width;
+  const index_type n = std::distance(first, last);
+  const value_type* x = n == 0 ? nullptr : detail::data(first);
+  for (index_type i = 0; i < n; i += block) {
+    detail::simd_acc<value_type> acc{};
+    detail::reduce_vertical(x + i, std::min(block, n - i), acc);
+    *out++ = detail::reduce_tree(acc);
+  }
+  return out;
+}
+
+// Sum of [first, last) on an OpenMP team of policy.threads threads (the
+// default team size if 0). Every thread reduces one contiguous
+// schedule(static) chunk with the SIMD kernel.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::omp_policy policy,
+                                                       Iter first,
+                                                       Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  value_type sum = 0;
+  if (n == 0) return sum;
+  const value_type* x = detail::data(first);
+  const int threads =
+      policy.threads > 0 ? policy.threads : omp_get_max_threads();
+#pragma omp parallel num_threads(threads) reduction(+ : sum)
+  {
+    index_type begin, end;
+    detail::static_chunk(n, omp_get_thread_num(), omp_get_num_threads(),
+                         begin, end);
+    sum += detail::reduce_simd(x + begin, end - begin);
+  }
+  return sum;
+}
+
+// Sum of [first, last) with tbb::parallel_reduce. Ranges are split in units
+// of whole vectors, so grain_size counts simd_width blocks, not elements.
+template <typename Iter, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(exec::tbb_policy,
+                                                       Iter first,
+                                                       Iter last,
+                                                       Partitioner& part,
+                                                       int grain_size = 1) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  return detail::reduce_tbb(
+      detail::data(first), n, part, grain_size,
+      [](const value_type* x, index_type m,
+         detail::simd_acc<value_type>& acc) {
+        detail::reduce_block(x, m, acc);
+      });
+}
+
+// Sum of [first, last) with tbb::parallel_reduce in chunks sized to the
+// cache of one core, see cache_partitioner. grain_size counts simd_width
+// blocks as above.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::tbb_policy,
+                                                       Iter first,
+                                                       Iter last,
+                                                       cache_partitioner& part,
+                                                       int grain_size = 1) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  using simd_value_type = detail::simd_acc<value_type>;
+  using namespace oneapi::tbb;
+  constexpr index_type unit = cache_unit<value_type>;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  const auto s = detail::split_for(part, x, n, 1, grain_size * simd_width);
+  const value_type* body = x + s.head;
+
+  simd_value_type simd_sum = parallel_reduce(
+      blocked_range<index_type>(0, s.units, s.grain), simd_value_type{},
+      [=](const blocked_range<index_type>& r, simd_value_type simd_acc) {
+        detail::reduce_block(body + r.begin() * unit,
+                             (r.end() - r.begin()) * unit, simd_acc);
+        return simd_acc;
+      },
+      [](simd_value_type lhs, const simd_value_type& rhs) {
+#pragma omp simd
+        for (index_type i = 0; i < simd_width; ++i) lhs[i] += rhs[i];
+        return lhs;
+      },
+      simple_partitioner{});
+  detail::reduce_block(x, s.head, simd_sum);
+  detail::reduce_block(body + s.units * unit, s.tail, simd_sum);
+  return detail::reduce_horizontal(simd_sum);
+}
+
+// Sum of [first, last) with tbb::parallel_reduce, using the partitioner and
+// grain size tuned for this size and thread count (auto_partitioner if there
+// is no tuning for it).
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::tbb_policy policy,
+                                                       Iter first,
+                                                       Iter last) {
+  return detail::with_tuned_partitioner<tuning::tbb_kernel::reduce>(
+      std::distance(first, last), [&](auto& part, int grain_size) {
+        return reduce(policy, first, last, part, grain_size);
+      });
+}
+
+// Sum of [first, last) with one tbb::parallel_reduce and static_partitioner
+// per NUMA node, each over the node's share of the range in its own arena.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::numa_policy,
+                                                       Iter first,
+                                                       Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  std::vector<value_type> partial(numa::node_count());
+  numa::for_each_node(n, [&](int node, index_type begin, index_type end) {
+    oneapi::tbb::static_partitioner part;
+    partial[node] = detail::reduce_tbb(
+        x + begin, end - begin, part, 1,
+        [](const value_type* xb, index_type m,
+           detail::simd_acc<value_type>& acc) {
+          detail::reduce_block(xb, m, acc);
+        });
+  });
+  return std::accumulate(partial.begin(), partial.end(), value_type{0});
+}
+
+// Sum of [first, last) on the calling thread with software prefetch.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::prefetch_policy<exec::simd_policy> policy,
+    Iter first,
+    Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  detail::simd_acc<value_type> acc{};
+  detail::reduce_block_prefetch(detail::data(first), n, acc, policy.distance);
+  return detail::reduce_horizontal(acc);
+}
+
+// Sum of [first, last) with tbb::parallel_reduce and software prefetch. The
+// prefetches stop `distance` elements before the end of every subrange.
+template <typename Iter, typename Partitioner>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::prefetch_policy<exec::tbb_policy> policy,
+    Iter first,
+    Iter last,
+    Partitioner& part,
+    int grain_size = 1) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const index_type distance = policy.distance;
+  return detail::reduce_tbb(
+      detail::data(first), n, part, grain_size,
+      [distance](const value_type* x, index_type m,
+                 detail::simd_acc<value_type>& acc) {
+        detail::reduce_block_prefetch(x, m, acc, distance);
+      });
+}
+
+// Without a policy, reduce on the calling thread.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(Iter first, Iter last) {
+  return reduce(exec::simd, first, last);
+}
+
+}  // namespace pad
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/ws/pool.hpp"
+
+namespace pad {
+
+namespace detail {
+// Grain of `units` units of work split on p when the caller gives none:
+// about eight tasks per worker, enough to balance by stealing without
+// paying a spawn per element.
+inline int pool_grain(const ws::pool& p, index_type units, int grain_size) {
+  if (grain_size > 0) return grain_size;
+  return static_cast<int>(std::max<index_type>(1, units / (8 * p.size())));
+}
+}  // namespace detail
+
+// Sum of [first, last) with ws::parallel_reduce on policy.pool. As with
+// exec::tbb, ranges are split in whole vectors and grain_size counts
+// simd_width blocks; 0 takes blocks / (8 * pool size).
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(
+    exec::pool_policy policy,
+    Iter first,
+    Iter last,
+    int grain_size = 0) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  using simd_value_type = detail::simd_acc<value_type>;
+  const index_type n = std::distance(first, last);
+  if (n == 0) return value_type{0};
+  const value_type* x = detail::data(first);
+  const index_type blocks = n / simd_width;
+
+  simd_value_type simd_sum = ws::parallel_reduce(
+      *policy.pool, 0, blocks,
+      detail::pool_grain(*policy.pool, blocks, grain_size), simd_value_type{},
+      [x](index_type begin, index_type end, simd_value_type acc) {
+        detail::reduce_block(x + begin * simd_width,
+                             (end - begin) * simd_width, acc);
+        return acc;
+      },
+      [](simd_value_type lhs, const simd_value_type& rhs) {
+#pragma omp simd
+        for (index_type i = 0; i < simd_width; ++i) lhs[i] += rhs[i];
+        return lhs;
+      });
+  detail::reduce_block(x + blocks * simd_width, n - blocks * simd_width,
+                       simd_sum);
+  return detail::reduce_horizontal(simd_sum);
+}
+
+// Y = a * X + Y with ws::parallel_for on policy.pool; grain_size counts
+// elements, 0 takes n / (8 * pool size).
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::pool_policy policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               int grain_size = 0) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  ws::parallel_for(*policy.pool, 0, n,
+                   detail::pool_grain(*policy.pool, n, grain_size),
+                   [=](index_type begin, index_type end) {
+                     detail::transform_block(a, x + begin, y + begin,
+                                             end - begin);
+                   });
+}
+
+}  // namespace pad
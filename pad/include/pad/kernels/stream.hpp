@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/topology.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// z[0, n) = a * x[0, n) + y[0, n) with regular stores; z may be y.
+template <typename Constant, typename T>
+void transform_to_simd(Constant a, const T* x, const T* y, T* z, index_type n) {
+  const T alpha = a;
+#pragma omp simd
+  for (index_type i = 0; i < n; ++i) {
+    z[i] = alpha * x[i] + y[i];
+  }
+}
+
+// transform_to_simd writing z with non-temporal stores: regular stores up to
+// the first cache line boundary of z, streaming stores for the whole vectors
+// after it, and regular ones for the tail. The closing sfence orders the
+// streaming stores before anything the caller does next, such as joining
+// the other threads.
+template <typename Constant, typename T>
+void transform_stream(Constant a, const T* x, const T* y, T* z, index_type n) {
+  const T alpha = a;
+  const index_type head = peel_count(z, n);
+  transform_to_simd(alpha, x, y, z, head);
+  x += head;
+  y += head;
+  z += head;
+  n -= head;
+
+  index_type body = 0;
+  if constexpr (std::is_same_v<T, float>) {
+#if defined(__AVX512F__)
+    const __m512 va = _mm512_set1_ps(alpha);
+    for (body = 0; body + 16 <= n; body += 16) {
+      _mm512_stream_ps(z + body,
+                       _mm512_fmadd_ps(va, _mm512_loadu_ps(x + body),
+                                       _mm512_loadu_ps(y + body)));
+    }
+#elif defined(__AVX__)
+    const __m256 va = _mm256_set1_ps(alpha);
+    for (body = 0; body + 8 <= n; body += 8) {
+#if defined(__FMA__)
+      const __m256 vz = _mm256_fmadd_ps(va, _mm256_loadu_ps(x + body),
+                                        _mm256_loadu_ps(y + body));
+#else
+      const __m256 vz = _mm256_add_ps(
+          _mm256_mul_ps(va, _mm256_loadu_ps(x + body)),
+          _mm256_loadu_ps(y + body));
+#endif
+      _mm256_stream_ps(z + body, vz);
+    }
+#elif defined(__SSE2__)
+    const __m128 va = _mm_set1_ps(alpha);
+    for (body = 0; body + 4 <= n; body += 4) {
+      _mm_stream_ps(z + body, _mm_add_ps(_mm_mul_ps(va, _mm_loadu_ps(x + body)),
+                                         _mm_loadu_ps(y + body)));
+    }
+#endif
+  }
+  // Other types leave the choice of instruction to the compiler.
+  T* zb = z + body;
+#pragma omp simd nontemporal(zb)
+  for (index_type i = 0; i < n - body; ++i) {
+    zb[i] = alpha * x[body + i] + y[body + i];
+  }
+#if defined(__SSE2__)
+  _mm_sfence();
+#endif
+}
+
+template <typename Constant, typename T>
+void transform_to_block(Constant a,
+                        const T* x,
+                        const T* y,
+                        T* z,
+                        index_type n) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_to_f32(a, x, y, z, n);
+  } else {
+    transform_to_simd(a, x, y, z, n);
+  }
+}
+
+template <typename Constant, typename T>
+void transform_stream_block(Constant a,
+                            const T* x,
+                            const T* y,
+                            T* z,
+                            index_type n) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_stream_f32(a, x, y, z, n);
+  } else {
+    transform_stream(a, x, y, z, n);
+  }
+}
+
+// Whether a call touching `bytes` of memory writes with streaming stores.
+// For automatic, compare against the last-level cache of one socket for a
+// single thread and against all of them for a parallel call.
+inline bool stream_stores(exec::store_hint hint,
+                          std::size_t bytes,
+                          bool parallel) {
+  switch (hint) {
+    case exec::store_hint::temporal:
+      return false;
+    case exec::store_hint::non_temporal:
+      return true;
+    default:
+      return bytes > (parallel ? topology::llc_total_bytes()
+                               : topology::llc_bytes());
+  }
+}
+
+// z = a * x + y on the calling thread with the stores `hint` asks for.
+template <typename Constant, typename T>
+void transform_to_serial(exec::store_hint hint,
+                         Constant a,
+                         const T* x,
+                         const T* y,
+                         T* z,
+                         index_type n) {
+  const std::size_t bytes = (z == y ? 2 : 3) * n * sizeof(T);
+  if (stream_stores(hint, bytes, false)) {
+    transform_stream_block(a, x, y, z, n);
+  } else {
+    transform_to_block(a, x, y, z, n);
+  }
+}
+
+// z = a * x + y with tbb::parallel_for and the stores `hint` asks for,
+// decided once for the whole range.
+template <typename Constant, typename T, typename Partitioner>
+void transform_to_parallel(exec::store_hint hint,
+                           Constant a,
+                           const T* x,
+                           const T* y,
+                           T* z,
+                           index_type n,
+                           Partitioner& part,
+                           int grain_size) {
+  const std::size_t bytes = (z == y ? 2 : 3) * n * sizeof(T);
+  if (stream_stores(hint, bytes, true)) {
+    transform_tbb(n, part, grain_size, [=](index_type begin, index_type m) {
+      transform_stream_block(a, x + begin, y + begin, z + begin, m);
+    });
+  } else {
+    transform_tbb(n, part, grain_size, [=](index_type begin, index_type m) {
+      transform_to_block(a, x + begin, y + begin, z + begin, m);
+    });
+  }
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Y = a * X + Y on the calling thread with the given store hint.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::store_policy<exec::simd_policy> policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  auto* y = detail::data(Ybegin);
+  detail::transform_to_serial(policy.hint, a, detail::data(Xbegin), y, y, n);
+}
+
+// Y = a * X + Y with tbb::parallel_for and the given store hint.
+template <typename Constant, typename Iter, typename OutIter,
+          typename Partitioner>
+void transform(exec::store_policy<exec::tbb_policy> policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               Partitioner& part,
+               int grain_size = 1) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  auto* y = detail::data(Ybegin);
+  detail::transform_to_parallel(policy.hint, a, detail::data(Xbegin), y, y, n,
+                                part, grain_size);
+}
+
+// Z = a * X + Y out of place on the calling thread. Z is written with
+// streaming stores when the hint says so.
+template <typename Constant, typename Iter, typename InIter, typename OutIter>
+void transform_to(exec::store_policy<exec::simd_policy> policy,
+                  Constant a,
+                  Iter Xbegin,
+                  Iter Xend,
+                  InIter Ybegin,
+                  OutIter Zbegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  detail::transform_to_serial(policy.hint, a, detail::data(Xbegin),
+                              detail::data(Ybegin), detail::data(Zbegin), n);
+}
+
+// Without a hint Z is only streamed once X, Y and Z no longer fit in the
+// last-level cache: unlike in place, nothing reads Z's lines before they are
+// written.
+template <typename Constant, typename Iter, typename InIter, typename OutIter>
+void transform_to(exec::simd_policy,
+                  Constant a,
+                  Iter Xbegin,
+                  Iter Xend,
+                  InIter Ybegin,
+                  OutIter Zbegin) {
+  transform_to(exec::stores(exec::simd, exec::store_hint::automatic), a,
+               Xbegin, Xend, Ybegin, Zbegin);
+}
+
+// Z = a * X + Y out of place with tbb::parallel_for; grain_size counts
+// elements.
+template <typename Constant, typename Iter, typename InIter, typename OutIter,
+          typename Partitioner>
+void transform_to(exec::store_policy<exec::tbb_policy> policy,
+                  Constant a,
+                  Iter Xbegin,
+                  Iter Xend,
+                  InIter Ybegin,
+                  OutIter Zbegin,
+                  Partitioner& part,
+                  int grain_size = 1) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  detail::transform_to_parallel(policy.hint, a, detail::data(Xbegin),
+                                detail::data(Ybegin), detail::data(Zbegin), n,
+                                part, grain_size);
+}
+
+template <typename Constant, typename Iter, typename InIter, typename OutIter,
+          typename Partitioner>
+void transform_to(exec::tbb_policy,
+                  Constant a,
+                  Iter Xbegin,
+                  Iter Xend,
+                  InIter Ybegin,
+                  OutIter Zbegin,
+                  Partitioner& part,
+                  int grain_size = 1) {
+  transform_to(exec::stores(exec::tbb, exec::store_hint::automatic), a,
+               Xbegin, Xend, Ybegin, Zbegin, part, grain_size);
+}
+
+template <typename Constant, typename Iter, typename InIter, typename OutIter>
+void transform_to(exec::tbb_policy policy,
+                  Constant a,
+                  Iter Xbegin,
+                  Iter Xend,
+                  InIter Ybegin,
+                  OutIter Zbegin) {
+  oneapi::tbb::auto_partitioner part;
+  transform_to(policy, a, Xbegin, Xend, Ybegin, Zbegin, part);
+}
+
+}  // namespace pad
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <omp.h>
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/partitioner.h>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/mask.hpp"
+#include "pad/kernels/partition.hpp"
+#include "pad/kernels/policy.hpp"
+#include "pad/numa.hpp"
+
+namespace pad {
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+// y[0, n) = a * x[0, n) + y[0, n). Whole vectors first, then one masked
+// epilogue for the n % simd_width trailing elements.
+template <typename Constant, typename T>
+void transform_simd(Constant a, const T* x, T* y, index_type n) {
+  const T alpha = a;
+  const index_type body = n / simd_width * simd_width;
+#pragma omp simd
+  for (index_type i = 0; i < body; ++i) {
+    y[i] = alpha * x[i] + y[i];
+  }
+  masked_axpy(alpha, x + body, y + body, n - body);
+}
+
+// transform_simd for an x that starts on a cache_line boundary. y is only
+// loaded and stored aligned when it happens to share that alignment.
+template <typename Constant, typename T>
+void transform_simd_aligned(Constant a, const T* x, T* y, index_type n) {
+  const T alpha = a;
+  const index_type body = n / simd_width * simd_width;
+  const T* xa = static_cast<const T*>(__builtin_assume_aligned(x, cache_line));
+  if (reinterpret_cast<std::uintptr_t>(y) % cache_line == 0) {
+    T* ya = static_cast<T*>(__builtin_assume_aligned(y, cache_line));
+#pragma omp simd aligned(xa, ya : cache_line)
+    for (index_type i = 0; i < body; ++i) {
+      ya[i] = alpha * xa[i] + ya[i];
+    }
+  } else {
+#pragma omp simd aligned(xa : cache_line)
+    for (index_type i = 0; i < body; ++i) {
+      y[i] = alpha * xa[i] + y[i];
+    }
+  }
+  masked_axpy(alpha, xa + body, y + body, n - body);
+}
+
+// transform_simd with a read prefetch of x and a write prefetch of y
+// `distance` elements ahead, once per cache line. The last `distance`
+// elements would prefetch past the end of the range and are done without.
+template <typename Constant, typename T>
+void transform_simd_prefetch(Constant a,
+                             const T* x,
+                             T* y,
+                             index_type n,
+                             index_type distance) {
+  constexpr index_type line = line_elements<T>;
+  const T alpha = a;
+  const index_type lines = distance > 0 && distance < n
+                               ? (n - distance) / line
+                               : 0;
+  for (index_type l = 0; l < lines; ++l) {
+    const T* xl = x + l * line;
+    T* yl = y + l * line;
+    __builtin_prefetch(xl + distance, 0, 3);
+    __builtin_prefetch(yl + distance, 1, 3);
+#pragma omp simd
+    for (index_type i = 0; i < line; ++i) {
+      yl[i] = alpha * xl[i] + yl[i];
+    }
+  }
+  transform_simd(a, x + lines * line, y + lines * line, n - lines * line);
+}
+
+// transform_simd through the kernel table picked at startup for float, the
+// baseline build of it otherwise.
+template <typename Constant, typename T>
+void transform_block(Constant a, const T* x, T* y, index_type n) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_f32(a, x, y, n);
+  } else {
+    transform_simd(a, x, y, n);
+  }
+}
+
+// Masked prologue up to the first cache line boundary of x, then the
+// aligned kernel, through the kernel table for float.
+template <typename Constant, typename T>
+void transform_block_aligned(Constant a, const T* x, T* y, index_type n) {
+  const index_type head = peel_count(x, n);
+  transform_simd(a, x, y, head);
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_aligned_f32(a, x + head, y + head, n - head);
+  } else {
+    transform_simd_aligned(a, x + head, y + head, n - head);
+  }
+}
+
+template <typename Constant, typename T>
+void transform_block_prefetch(Constant a,
+                              const T* x,
+                              T* y,
+                              index_type n,
+                              index_type distance) {
+  if constexpr (isa_dispatch && std::is_same_v<T, float>) {
+    isa::kernels().transform_prefetch_f32(a, x, y, n, distance);
+  } else {
+    transform_simd_prefetch(a, x, y, n, distance);
+  }
+}
+
+// tbb::parallel_for over [0, n), `block(begin, count)` transforming each
+// subrange.
+template <typename Partitioner, typename Block>
+void transform_tbb(index_type n,
+                   Partitioner& part,
+                   int grain_size,
+                   Block block) {
+  using namespace oneapi::tbb;
+  parallel_for(
+      blocked_range<index_type>(0, n, grain_size),
+      [=](const blocked_range<index_type>& r) {
+        block(r.begin(), r.end() - r.begin());
+      },
+      part);
+}
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+// Y = a * X + Y over [Xbegin, Xend) on the calling thread.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::simd_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  detail::transform_block(a, detail::data(Xbegin), detail::data(Ybegin), n);
+}
+
+// Y = a * X + Y over [Xbegin, Xend) on the calling thread, peeling the head
+// of X so that the main loop only issues aligned loads from it.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::aligned_simd_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  detail::transform_block_aligned(a, detail::data(Xbegin),
+                                  detail::data(Ybegin), n);
+}
+
+// Y = a * X + Y on an OpenMP team of policy.threads threads (the default
+// team size if 0), one schedule(static) chunk per thread.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::omp_policy policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  const int threads =
+      policy.threads > 0 ? policy.threads : omp_get_max_threads();
+#pragma omp parallel num_threads(threads)
+  {
+    index_type begin, end;
+    detail::static_chunk(n, omp_get_thread_num(), omp_get_num_threads(),
+                         begin, end);
+    detail::transform_block(a, x + begin, y + begin, end - begin);
+  }
+}
+
+// Y = a * X + Y with tbb::parallel_for; grain_size counts elements.
+template <typename Constant, typename Iter, typename OutIter,
+          typename Partitioner>
+void transform(exec::tbb_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               Partitioner& part,
+               int grain_size = 1) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  detail::transform_tbb(n, part, grain_size,
+                        [=](index_type begin, index_type m) {
+                          detail::transform_block(a, x + begin, y + begin, m);
+                        });
+}
+
+// Y = a * X + Y with tbb::parallel_for in chunks sized to the cache of one
+// core, see cache_partitioner. grain_size counts elements.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::tbb_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               cache_partitioner& part,
+               int grain_size = 1) {
+  using namespace oneapi::tbb;
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  using value_type = std::remove_cv_t<std::remove_pointer_t<decltype(x)>>;
+  constexpr index_type unit = cache_unit<value_type>;
+  // Chunk edges follow the lines of y, the stream that is written.
+  const auto s = detail::split_for(part, static_cast<const value_type*>(y), n,
+                                   2, grain_size);
+  parallel_for(
+      blocked_range<index_type>(0, s.units, s.grain),
+      [=](const blocked_range<index_type>& r) {
+        const index_type begin = s.head + r.begin() * unit;
+        detail::transform_block(a, x + begin, y + begin,
+                                (r.end() - r.begin()) * unit);
+      },
+      simple_partitioner{});
+  detail::transform_block(a, x, y, s.head);
+  const index_type tail = s.head + s.units * unit;
+  detail::transform_block(a, x + tail, y + tail, s.tail);
+}
+
+// Y = a * X + Y with tbb::parallel_for, using the partitioner and grain size
+// tuned for this size and thread count (auto_partitioner if there is no
+// tuning for it).
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::tbb_policy policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  detail::with_tuned_partitioner<tuning::tbb_kernel::transform>(
+      std::distance(Xbegin, Xend), [&](auto& part, int grain_size) {
+        transform(policy, a, Xbegin, Xend, Ybegin, part, grain_size);
+      });
+}
+
+// Y = a * X + Y with one tbb::parallel_for and static_partitioner per NUMA
+// node, each over the node's share of the range in its own arena.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::numa_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  numa::for_each_node(n, [=](int, index_type begin, index_type end) {
+    oneapi::tbb::static_partitioner part;
+    detail::transform_tbb(end - begin, part, 1,
+                          [=](index_type b, index_type m) {
+                            detail::transform_block(a, x + begin + b,
+                                                    y + begin + b, m);
+                          });
+  });
+}
+
+// Y = a * X + Y on the calling thread with software prefetch.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::prefetch_policy<exec::simd_policy> policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  detail::transform_block_prefetch(a, detail::data(Xbegin),
+                                   detail::data(Ybegin), n, policy.distance);
+}
+
+// Y = a * X + Y with tbb::parallel_for and software prefetch. The
+// prefetches stop `distance` elements before the end of every subrange.
+template <typename Constant, typename Iter, typename OutIter,
+          typename Partitioner>
+void transform(exec::prefetch_policy<exec::tbb_policy> policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin,
+               Partitioner& part,
+               int grain_size = 1) {
+  const index_type n = std::distance(Xbegin, Xend);
+  if (n == 0) return;
+  const index_type distance = policy.distance;
+  const auto* x = detail::data(Xbegin);
+  auto* y = detail::data(Ybegin);
+  detail::transform_tbb(n, part, grain_size,
+                        [=](index_type begin, index_type m) {
+                          detail::transform_block_prefetch(
+                              a, x + begin, y + begin, m, distance);
+                        });
+}
+
+// Without a policy, transform on the calling thread.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(Constant a, Iter Xbegin, Iter Xend, OutIter Ybegin) {
+  transform(exec::simd, a, Xbegin, Xend, Ybegin);
+}
+
+}  // namespace pad
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <iterator>
+#include <type_traits>
+
+#include "pad/kernels/policy.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/tuning.hpp"
+
+namespace pad {
+
+// Sum of [first, last) on the calling thread with the tuned float kernel.
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type reduce(exec::tuned_policy,
+                                                       Iter first,
+                                                       Iter last) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  if constexpr (std::is_same_v<value_type, float>) {
+    const index_type n = std::distance(first, last);
+    if (n == 0) return value_type{0};
+    if (const auto* kernel = tuning::reduce_f32(n)) {
+      return kernel->reduce(detail::data(first), n);
+    }
+  }
+  return reduce(exec::simd, first, last);
+}
+
+// Y = a * X + Y on the calling thread with the tuned float kernel.
+template <typename Constant, typename Iter, typename OutIter>
+void transform(exec::tuned_policy,
+               Constant a,
+               Iter Xbegin,
+               Iter Xend,
+               OutIter Ybegin) {
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  if constexpr (std::is_same_v<value_type, float>) {
+    const index_type n = std::distance(Xbegin, Xend);
+    if (n == 0) return;
+    if (const auto* kernel = tuning::transform_f32(n)) {
+      kernel->transform(a, detail::data(Xbegin), detail::data(Ybegin), n);
+      return;
+    }
+  }
+  transform(exec::simd, a, Xbegin, Xend, Ybegin);
+}
+
+}  // namespace pad
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+
+// Shapes of the kernel grid: vector width in elements, number of
+// independent accumulators (vectors per loop iteration), and whether the
+// main loop starts on a cache line boundary of x after a peeled prologue.
+inline constexpr int variant_widths[] = {4, 8, 16};
+inline constexpr int variant_max_unroll = 8;
+inline constexpr std::size_t variant_count =
+    std::size(variant_widths) * variant_max_unroll * 2;
+
+namespace detail {
+inline namespace PAD_ISA_NAMESPACE {
+template <int Width, int Unroll, bool Aligned>
+struct variant {
+  static_assert(Width == 4 || Width == 8 || Width == 16, "width 4, 8 or 16");
+  static_assert(Unroll >= 1 && Unroll <= variant_max_unroll, "unroll 1 to 8");
+
+  static constexpr index_type step = Width * Unroll;
+
+  // Sum of x[0, n)
+  template <typename T>
+  static T reduce(const T* x, index_type n) {
+    T sum = 0;
+    const index_type head = Aligned ? peel_count(x, n) : 0;
+    for (index_type i = 0; i < head; ++i) sum += x[i];
+    const T* xb = Aligned ? static_cast<const T*>(
+                                __builtin_assume_aligned(x + head, cache_line))
+                          : x;
+    const index_type m = n - head;
+    const index_type blocks = m / step;
+
+    T acc[Unroll][Width] = {};
+    for (index_type u = 0; u < blocks; ++u) {
+      add(xb + u * step, acc, std::make_index_sequence<Unroll>{});
+    }
+    for (int k = 1; k < Unroll; ++k) {
+#pragma omp simd simdlen(Width)
+      for (int i = 0; i < Width; ++i) acc[0][i] += acc[k][i];
+    }
+    for (int w = Width / 2; w > 0; w /= 2) {
+      for (int i = 0; i < w; ++i) acc[0][i] += acc[0][i + w];
+    }
+    sum += acc[0][0];
+    for (index_type i = blocks * step; i < m; ++i) sum += xb[i];
+    return sum;
+  }
+
+  // y[0, n) = a * x[0, n) + y[0, n)
+  template <typename T>
+  static void transform(T a, const T* x, T* y, index_type n) {
+    const index_type head = Aligned ? peel_count(x, n) : 0;
+    for (index_type i = 0; i < head; ++i) y[i] = a * x[i] + y[i];
+    const T* xb = Aligned ? static_cast<const T*>(
+                                __builtin_assume_aligned(x + head, cache_line))
+                          : x;
+    T* yb = y + head;
+    const index_type m = n - head;
+    const index_type blocks = m / step;
+
+    for (index_type u = 0; u < blocks; ++u) {
+      axpy(a, xb + u * step, yb + u * step,
+           std::make_index_sequence<Unroll>{});
+    }
+#pragma omp simd
+    for (index_type i = blocks * step; i < m; ++i) yb[i] = a * xb[i] + yb[i];
+  }
+
+ private:
+  template <typename T, std::size_t... K>
+  static void add(const T* x, T (&acc)[Unroll][Width],
+                  std::index_sequence<K...>) {
+    (
+        [&](T* ak, const T* xk) {
+#pragma omp simd simdlen(Width)
+          for (int i = 0; i < Width; ++i) ak[i] += xk[i];
+        }(acc[K], x + K * Width),
+        ...);
+  }
+
+  template <typename T, std::size_t... K>
+  static void axpy(T a, const T* x, T* y, std::index_sequence<K...>) {
+    (
+        [&](const T* xk, T* yk) {
+#pragma omp simd simdlen(Width)
+          for (int i = 0; i < Width; ++i) yk[i] = a * xk[i] + yk[i];
+        }(x + K * Width, y + K * Width),
+        ...);
+  }
+};
+
+// Grid entry I: width varies slowest, then unroll, then alignment.
+template <typename T, std::size_t I>
+constexpr isa::kernel_variant<T> make_variant() {
+  constexpr int width = variant_widths[I / (variant_max_unroll * 2)];
+  constexpr int unroll = I / 2 % variant_max_unroll + 1;
+  constexpr bool aligned = I % 2 == 1;
+  using V = variant<width, unroll, aligned>;
+  return {width, unroll, aligned, &V::template reduce<T>,
+          &V::template transform<T>};
+}
+
+template <typename T, std::size_t... I>
+constexpr std::array<isa::kernel_variant<T>, sizeof...(I)> make_variants(
+    std::index_sequence<I...>) {
+  return {make_variant<T, I>()...};
+}
+
+// Every kernel of the grid, instantiated for T in this ISA build.
+template <typename T>
+inline constexpr std::array<isa::kernel_variant<T>, variant_count> variants =
+    make_variants<T>(std::make_index_sequence<variant_count>{});
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace detail
+
+}  // namespace pad
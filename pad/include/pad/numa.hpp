@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include <oneapi/tbb/task_arena.h>
+#include <oneapi/tbb/task_group.h>
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+namespace numa {
+
+// Number of NUMA nodes oneTBB sees, at least 1. Without tbbbind (and so
+// without NUMA information) the whole machine counts as one node.
+int node_count();
+
+// task_arena whose threads are constrained to NUMA node `node`, for node in
+// [0, node_count()). Created on first use and kept for the whole process.
+oneapi::tbb::task_arena& arena(int node);
+
+// Runs f(node, begin, end) in the arena of every node at the same time,
+// [begin, end) being the node's contiguous share of [0, n) in node order
+// (as schedule(static) would hand them out), and waits for all of them.
+template <typename F>
+void for_each_node(index_type n, F&& f) {
+  const int nodes = node_count();
+  std::vector<oneapi::tbb::task_group> groups(nodes);
+  for (int node = 0; node < nodes; ++node) {
+    index_type begin, end;
+    detail::static_chunk(n, node, nodes, begin, end);
+    arena(node).execute([&, node, begin, end] {
+      groups[node].run([&f, node, begin, end] { f(node, begin, end); });
+    });
+  }
+  for (int node = 0; node < nodes; ++node) {
+    arena(node).execute([&groups, node] { groups[node].wait(); });
+  }
+}
+
+}  // namespace numa
+}  // namespace pad
@@ -0,0 +1,80 @@
+#pragma once
+
+// pad::simd<T, W, Backend>: a W-lane vector of T with load/store, masked
+// load/store of the first r lanes, FMA and horizontal add. The backends are
+// interchangeable, so one kernel can be compiled against each of them and
+// the generated code compared.
+//
+//   simd_backend::scalar  W-element array with omp simd loops, always there
+//   simd_backend::ume     UME::SIMD, if <umesimd/UMESimd.h> is found
+//   simd_backend::stdx    std::experimental::simd, if <experimental/simd> is
+//   simd_backend::avx     raw intrinsics: float/double with AVX2 for 256-bit
+//                         and AVX-512F for 512-bit vectors, built with
+//                         target attributes whatever the -march of the TU
+//
+// PAD_SIMD_HAVE_<BACKEND> tells whether a backend is usable in this TU. Run
+// kernels over a backend through simd_isa (below), which builds them for the
+// ISA the backend needs and tells whether this CPU has it.
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+
+namespace simd_backend {
+struct scalar {
+  static constexpr const char* name = "scalar";
+};
+struct ume {
+  static constexpr const char* name = "ume";
+};
+struct stdx {
+  static constexpr const char* name = "stdx";
+};
+struct avx {
+  static constexpr const char* name = "avx";
+};
+}  // namespace simd_backend
+
+template <typename T, int W, typename Backend = simd_backend::scalar>
+class simd;
+
+// run(f) calls f() with everything it calls inlined and built for the ISA
+// vectors of type V need; call it only when supported(). Every backend but
+// avx builds for the TU's own -march and just calls f().
+template <typename V>
+struct simd_isa {
+  static bool supported() { return true; }
+  template <typename F>
+  static void run(F&& f) {
+    f();
+  }
+};
+
+}  // namespace pad
+
+#include "pad/simd/scalar.hpp"
+
+#if __has_include(<umesimd/UMESimd.h>)
+#define PAD_SIMD_HAVE_UME 1
+#include "pad/simd/ume.hpp"
+#else
+#define PAD_SIMD_HAVE_UME 0
+#endif
+
+#if __has_include(<experimental/simd>)
+#define PAD_SIMD_HAVE_STDX 1
+#include "pad/simd/stdx.hpp"
+#else
+#define PAD_SIMD_HAVE_STDX 0
+#endif
+
+// The avx backend only needs a compiler that takes target attributes; the
+// CPU is checked at run time by simd_isa<V>::supported().
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PAD_SIMD_HAVE_AVX2 1
+#define PAD_SIMD_HAVE_AVX512 1
+#include "pad/simd/avx.hpp"
+#else
+#define PAD_SIMD_HAVE_AVX2 0
+#define PAD_SIMD_HAVE_AVX512 0
+#endif
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include "pad/isa.hpp"
+#include "pad/simd.hpp"
+
+// Every member is built for its ISA with a target attribute, so that the
+// backend exists in the baseline (x86-64-v2) build; simd_isa<V>::run inlines
+// a whole kernel into one function built for the same ISA.
+#define PAD_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define PAD_SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+namespace pad {
+
+// Raw intrinsics: simd<float, 8> and simd<double, 4> with AVX2 and FMA,
+// simd<float, 16> and simd<double, 8> with AVX-512F. Masked operations take
+// 0 <= r <= width.
+
+template <>
+class simd<float, 8, simd_backend::avx> {
+ public:
+  using value_type = float;
+  using backend = simd_backend::avx;
+  static constexpr int width = 8;
+
+  simd() = default;
+  PAD_SIMD_TARGET_AVX2
+  simd(float s) : v_(_mm256_set1_ps(s)) {}
+
+  PAD_SIMD_TARGET_AVX2
+  simd& load(const float* p) {
+    v_ = _mm256_loadu_ps(p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  simd& masked_load(const float* p, index_type r) {
+    v_ = _mm256_maskload_ps(p, tail_mask(r));
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  void store(float* p) const { _mm256_storeu_ps(p, v_); }
+  PAD_SIMD_TARGET_AVX2
+  void masked_store(float* p, index_type r) const {
+    _mm256_maskstore_ps(p, tail_mask(r), v_);
+  }
+
+  PAD_SIMD_TARGET_AVX2
+  simd& operator+=(const simd& o) {
+    v_ = _mm256_add_ps(v_, o.v_);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  PAD_SIMD_TARGET_AVX2
+  friend simd operator*(const simd& a, const simd& b) {
+    return simd(_mm256_mul_ps(a.v_, b.v_));
+  }
+  PAD_SIMD_TARGET_AVX2
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    return simd(_mm256_fmadd_ps(a.v_, b.v_, c.v_));
+  }
+
+  // Shuffle tree: 256 -> 128 -> 64 -> 32 bits.
+  PAD_SIMD_TARGET_AVX2
+  float hadd() const {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v_),
+                          _mm256_extractf128_ps(v_, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+  }
+
+ private:
+  PAD_SIMD_TARGET_AVX2
+  explicit simd(__m256 v) : v_(v) {}
+
+  PAD_SIMD_TARGET_AVX2
+  static __m256i tail_mask(index_type r) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(r)),
+                              _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+
+  __m256 v_;
+};
+
+template <>
+class simd<double, 4, simd_backend::avx> {
+ public:
+  using value_type = double;
+  using backend = simd_backend::avx;
+  static constexpr int width = 4;
+
+  simd() = default;
+  PAD_SIMD_TARGET_AVX2
+  simd(double s) : v_(_mm256_set1_pd(s)) {}
+
+  PAD_SIMD_TARGET_AVX2
+  simd& load(const double* p) {
+    v_ = _mm256_loadu_pd(p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  simd& masked_load(const double* p, index_type r) {
+    v_ = _mm256_maskload_pd(p, tail_mask(r));
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  void store(double* p) const { _mm256_storeu_pd(p, v_); }
+  PAD_SIMD_TARGET_AVX2
+  void masked_store(double* p, index_type r) const {
+    _mm256_maskstore_pd(p, tail_mask(r), v_);
+  }
+
+  PAD_SIMD_TARGET_AVX2
+  simd& operator+=(const simd& o) {
+    v_ = _mm256_add_pd(v_, o.v_);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX2
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  PAD_SIMD_TARGET_AVX2
+  friend simd operator*(const simd& a, const simd& b) {
+    return simd(_mm256_mul_pd(a.v_, b.v_));
+  }
+  PAD_SIMD_TARGET_AVX2
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    return simd(_mm256_fmadd_pd(a.v_, b.v_, c.v_));
+  }
+
+  PAD_SIMD_TARGET_AVX2
+  double hadd() const {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v_),
+                           _mm256_extractf128_pd(v_, 1));
+    s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+    return _mm_cvtsd_f64(s);
+  }
+
+ private:
+  PAD_SIMD_TARGET_AVX2
+  explicit simd(__m256d v) : v_(v) {}
+
+  PAD_SIMD_TARGET_AVX2
+  static __m256i tail_mask(index_type r) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(r),
+                              _mm256_setr_epi64x(0, 1, 2, 3));
+  }
+
+  __m256d v_;
+};
+template <>
+class simd<float, 16, simd_backend::avx> {
+ public:
+  using value_type = float;
+  using backend = simd_backend::avx;
+  static constexpr int width = 16;
+
+  simd() = default;
+  PAD_SIMD_TARGET_AVX512
+  simd(float s) : v_(_mm512_set1_ps(s)) {}
+
+  PAD_SIMD_TARGET_AVX512
+  simd& load(const float* p) {
+    v_ = _mm512_loadu_ps(p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  simd& masked_load(const float* p, index_type r) {
+    v_ = _mm512_maskz_loadu_ps(tail_mask(r), p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  void store(float* p) const { _mm512_storeu_ps(p, v_); }
+  PAD_SIMD_TARGET_AVX512
+  void masked_store(float* p, index_type r) const {
+    _mm512_mask_storeu_ps(p, tail_mask(r), v_);
+  }
+
+  PAD_SIMD_TARGET_AVX512
+  simd& operator+=(const simd& o) {
+    v_ = _mm512_add_ps(v_, o.v_);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  PAD_SIMD_TARGET_AVX512
+  friend simd operator*(const simd& a, const simd& b) {
+    return simd(_mm512_mul_ps(a.v_, b.v_));
+  }
+  PAD_SIMD_TARGET_AVX512
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    return simd(_mm512_fmadd_ps(a.v_, b.v_, c.v_));
+  }
+
+  PAD_SIMD_TARGET_AVX512
+  float hadd() const { return _mm512_reduce_add_ps(v_); }
+
+ private:
+  PAD_SIMD_TARGET_AVX512
+  explicit simd(__m512 v) : v_(v) {}
+
+  PAD_SIMD_TARGET_AVX512
+  static __mmask16 tail_mask(index_type r) {
+    return static_cast<__mmask16>((1u << r) - 1);
+  }
+
+  __m512 v_;
+};
+
+template <>
+class simd<double, 8, simd_backend::avx> {
+ public:
+  using value_type = double;
+  using backend = simd_backend::avx;
+  static constexpr int width = 8;
+
+  simd() = default;
+  PAD_SIMD_TARGET_AVX512
+  simd(double s) : v_(_mm512_set1_pd(s)) {}
+
+  PAD_SIMD_TARGET_AVX512
+  simd& load(const double* p) {
+    v_ = _mm512_loadu_pd(p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  simd& masked_load(const double* p, index_type r) {
+    v_ = _mm512_maskz_loadu_pd(tail_mask(r), p);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  void store(double* p) const { _mm512_storeu_pd(p, v_); }
+  PAD_SIMD_TARGET_AVX512
+  void masked_store(double* p, index_type r) const {
+    _mm512_mask_storeu_pd(p, tail_mask(r), v_);
+  }
+
+  PAD_SIMD_TARGET_AVX512
+  simd& operator+=(const simd& o) {
+    v_ = _mm512_add_pd(v_, o.v_);
+    return *this;
+  }
+  PAD_SIMD_TARGET_AVX512
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  PAD_SIMD_TARGET_AVX512
+  friend simd operator*(const simd& a, const simd& b) {
+    return simd(_mm512_mul_pd(a.v_, b.v_));
+  }
+  PAD_SIMD_TARGET_AVX512
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    return simd(_mm512_fmadd_pd(a.v_, b.v_, c.v_));
+  }
+
+  PAD_SIMD_TARGET_AVX512
+  double hadd() const { return _mm512_reduce_add_pd(v_); }
+
+ private:
+  PAD_SIMD_TARGET_AVX512
+  explicit simd(__m512d v) : v_(v) {}
+
+  PAD_SIMD_TARGET_AVX512
+  static __mmask8 tail_mask(index_type r) {
+    return static_cast<__mmask8>((1u << r) - 1);
+  }
+
+  __m512d v_;
+};
+
+namespace detail {
+// simd_isa of the AVX2 and AVX-512F vectors: f and all it calls inlined into
+// one function with the target of the vectors, run on CPUs isa::detect()
+// finds the ISA on.
+struct avx2_isa {
+  static bool supported() { return isa::detect() >= isa::level::avx2; }
+  template <typename F>
+  PAD_SIMD_TARGET_AVX2 __attribute__((flatten))
+  static void run(F&& f) {
+    f();
+  }
+};
+
+struct avx512_isa {
+  static bool supported() { return isa::detect() >= isa::level::avx512f; }
+  template <typename F>
+  PAD_SIMD_TARGET_AVX512 __attribute__((flatten))
+  static void run(F&& f) {
+    f();
+  }
+};
+}  // namespace detail
+
+template <>
+struct simd_isa<simd<float, 8, simd_backend::avx>> : detail::avx2_isa {};
+template <>
+struct simd_isa<simd<double, 4, simd_backend::avx>> : detail::avx2_isa {};
+template <>
+struct simd_isa<simd<float, 16, simd_backend::avx>> : detail::avx512_isa {};
+template <>
+struct simd_isa<simd<double, 8, simd_backend::avx>> : detail::avx512_isa {};
+
+}  // namespace pad
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "pad/simd.hpp"
+
+namespace pad {
+
+// Plain array; every operation is an omp simd loop over the W lanes and it
+// is up to the compiler to map them onto vector instructions.
+template <typename T, int W>
+class simd<T, W, simd_backend::scalar> {
+ public:
+  using value_type = T;
+  using backend = simd_backend::scalar;
+  static constexpr int width = W;
+
+  simd() = default;
+  simd(T s) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) v_[i] = s;
+  }
+
+  simd& load(const T* p) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) v_[i] = p[i];
+    return *this;
+  }
+  // Lanes [0, r) from p, the others zero; nothing at or beyond p + r is read.
+  simd& masked_load(const T* p, index_type r) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) v_[i] = i < r ? p[i] : T(0);
+    return *this;
+  }
+  void store(T* p) const {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) p[i] = v_[i];
+  }
+  void masked_store(T* p, index_type r) const {
+#pragma omp simd
+    for (int i = 0; i < r; ++i) p[i] = v_[i];
+  }
+
+  simd& operator+=(const simd& o) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) v_[i] += o.v_[i];
+    return *this;
+  }
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  friend simd operator*(simd a, const simd& b) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) a.v_[i] *= b.v_[i];
+    return a;
+  }
+  // a * b + c
+  friend simd fma(const simd& a, const simd& b, simd c) {
+#pragma omp simd
+    for (int i = 0; i < W; ++i) c.v_[i] = a.v_[i] * b.v_[i] + c.v_[i];
+    return c;
+  }
+
+  T hadd() const {
+    T sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (int i = 0; i < W; ++i) sum += v_[i];
+    return sum;
+  }
+
+ private:
+  T v_[W];
+};
+
+}  // namespace pad
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <experimental/simd>
+
+#include "pad/simd.hpp"
+
+namespace pad {
+
+template <typename T, int W>
+class simd<T, W, simd_backend::stdx> {
+  using native_type = std::experimental::fixed_size_simd<T, W>;
+
+ public:
+  using value_type = T;
+  using backend = simd_backend::stdx;
+  static constexpr int width = W;
+
+  simd() = default;
+  simd(T s) : v_(s) {}
+
+  simd& load(const T* p) {
+    v_.copy_from(p, std::experimental::element_aligned);
+    return *this;
+  }
+  simd& masked_load(const T* p, index_type r) {
+    v_ = T(0);
+    std::experimental::where(lanes() < T(r), v_)
+        .copy_from(p, std::experimental::element_aligned);
+    return *this;
+  }
+  void store(T* p) const {
+    v_.copy_to(p, std::experimental::element_aligned);
+  }
+  void masked_store(T* p, index_type r) const {
+    std::experimental::where(lanes() < T(r), v_)
+        .copy_to(p, std::experimental::element_aligned);
+  }
+
+  simd& operator+=(const simd& o) {
+    v_ += o.v_;
+    return *this;
+  }
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  friend simd operator*(simd a, const simd& b) {
+    a.v_ *= b.v_;
+    return a;
+  }
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    return simd(std::experimental::fma(a.v_, b.v_, c.v_));
+  }
+
+  T hadd() const { return std::experimental::reduce(v_); }
+
+ private:
+  explicit simd(const native_type& v) : v_(v) {}
+
+  // {0, 1, ..., W - 1}; exact in T for every supported width
+  static native_type lanes() {
+    return native_type([](auto i) { return T(i); });
+  }
+
+  native_type v_;
+};
+
+}  // namespace pad
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+#include <umesimd/UMESimd.h>
+
+#include "pad/simd.hpp"
+
+namespace pad {
+
+template <typename T, int W>
+class simd<T, W, simd_backend::ume> {
+  using native_type = UME::SIMD::SIMDVec<T, W>;
+  using mask_type = UME::SIMD::SIMDVecMask<W>;
+
+ public:
+  using value_type = T;
+  using backend = simd_backend::ume;
+  static constexpr int width = W;
+
+  simd() = default;
+  simd(T s) : v_(s) {}
+
+  simd& load(const T* p) {
+    v_.load(p);
+    return *this;
+  }
+  simd& masked_load(const T* p, index_type r) {
+    v_ = T(0);
+    v_.load(tail_mask(r), p);
+    return *this;
+  }
+  void store(T* p) const { v_.store(p); }
+  void masked_store(T* p, index_type r) const { v_.store(tail_mask(r), p); }
+
+  simd& operator+=(const simd& o) {
+    v_ += o.v_;
+    return *this;
+  }
+  friend simd operator+(simd a, const simd& b) { return a += b; }
+  friend simd operator*(simd a, const simd& b) {
+    a.v_ = a.v_ * b.v_;
+    return a;
+  }
+  friend simd fma(const simd& a, const simd& b, const simd& c) {
+    simd r;
+    r.v_ = a.v_.fmuladd(b.v_, c.v_);
+    return r;
+  }
+
+  T hadd() const { return v_.hadd(); }
+
+ private:
+  // Lanes [0, r) set
+  static mask_type tail_mask(index_type r) {
+    alignas(64) static constexpr std::uint32_t iota[32] = {
+        0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
+    static_assert(W <= 32, "lane index table holds 32 lanes");
+    UME::SIMD::SIMDVec<std::uint32_t, W> lanes;
+    lanes.load(iota);
+    return lanes.cmplt(static_cast<std::uint32_t>(r));
+  }
+
+  native_type v_;
+};
+
+}  // namespace pad
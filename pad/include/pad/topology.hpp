@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace pad {
+namespace topology {
+
+// Size in bytes of one last-level cache instance (typically the L3 of one
+// socket), from hwloc on first use. 8 MiB when hwloc reports no cache.
+std::size_t llc_bytes();
+
+// Sum of all last-level cache instances of the machine.
+std::size_t llc_total_bytes();
+
+// Bytes of the level 1, 2 or 3 cache available to one core: the size of a
+// cache instance divided by the cores that share it, from hwloc on first
+// use. 32 KiB, 256 KiB and 2 MiB when hwloc reports no such cache.
+std::size_t cache_bytes_per_core(int level);
+
+// 16 hex digits identifying the machine as hwloc sees it: CPU model, number
+// of packages, NUMA nodes, cores and PUs, and the cache sizes. Tuning results
+// are only reused on a host with the same fingerprint.
+const std::string& fingerprint();
+
+}  // namespace topology
+}  // namespace pad
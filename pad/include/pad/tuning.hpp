@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+namespace tuning {
+
+// Size classes the tuner measures, by their largest element count. The last
+// class also covers every larger size.
+inline constexpr index_type size_classes[] = {index_type{1} << 12,
+                                              index_type{1} << 15,
+                                              index_type{1} << 18,
+                                              index_type{1} << 21,
+                                              index_type{1} << 24};
+
+// The fastest kernel of the grid for one operation and size class.
+struct choice {
+  index_type max_elements;
+  isa::level isa;
+  int width;
+  int unroll;
+  bool aligned;
+};
+
+struct table {
+  std::vector<choice> reduce;
+  std::vector<choice> transform;
+};
+
+// $PAD_TUNING_FILE if set, else pad/tuning.txt below $XDG_CACHE_HOME or
+// $HOME/.cache.
+std::string default_path();
+
+// Text format, one choice per line, '#' starts a comment:
+//   reduce|transform <max_elements> <isa> <width> <unroll> <aligned 0|1>
+bool write(const std::string& path, const table& t);
+bool read(const std::string& path, table& t);
+
+// Where the table in use came from, or an empty string without one.
+const std::string& loaded_from();
+
+// Tuned float kernels for n elements, from the file at default_path() read
+// on first use. nullptr without a usable entry, e.g. when the file is
+// missing or was written on a host with a wider ISA.
+const isa::kernel_variant<float>* reduce_f32(index_type n);
+const isa::kernel_variant<float>* transform_f32(index_type n);
+
+// Partitioners pad-tune-tbb chooses between for the TBB kernels.
+enum class partitioner { automatic, simple, static_, affinity };
+enum class tbb_kernel { reduce, transform };
+
+// "auto", "simple", "static", "affinity"; "reduce", "transform"
+const char* name(partitioner p);
+const char* name(tbb_kernel k);
+
+// Size classes of the TBB tuning, by their largest element count. The last
+// class also covers every larger size.
+inline constexpr index_type tbb_size_classes[] = {index_type{1} << 14,
+                                                  index_type{1} << 17,
+                                                  index_type{1} << 20,
+                                                  index_type{1} << 23,
+                                                  index_type{1} << 26};
+
+// The fastest (partitioner, grain size) for one kernel, size class and
+// thread count. grain_size is in the unit of the kernel's grain_size
+// argument.
+struct tbb_choice {
+  tbb_kernel kernel;
+  index_type max_elements;
+  int threads;
+  partitioner part;
+  int grain_size;
+};
+
+// $PAD_TBB_TUNING_FILE if set, else pad/tbb-<fingerprint>.txt next to
+// default_path(), keyed by topology::fingerprint() so that results are never
+// picked up on a different machine.
+std::string tbb_cache_path();
+
+// Text format, one choice per line, '#' starts a comment:
+//   reduce|transform <max_elements> <threads> <partitioner> <grain_size>
+bool write(const std::string& path, const std::vector<tbb_choice>& choices);
+bool read(const std::string& path, std::vector<tbb_choice>& choices);
+
+// Where the TBB choices in use came from, or an empty string without any.
+const std::string& tbb_loaded_from();
+
+// Tuned choice for `kernel` over n elements on `threads` threads, from the
+// file at tbb_cache_path() read on first use. Uses the entries of the
+// nearest tuned thread count; nullptr if there are none for the kernel.
+const tbb_choice* tbb_lookup(tbb_kernel kernel, index_type n, int threads);
+
+}  // namespace tuning
+}  // namespace pad
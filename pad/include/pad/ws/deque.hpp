@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pad {
+namespace ws {
+
+// Chase-Lev work-stealing deque, with the memory orders of Le et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+// The owner pushes and pops at the bottom, any other thread steals from the
+// top. T is a small trivially copyable type, in practice a task pointer.
+// The ring grows when full; replaced rings stay alive until the deque is
+// destroyed, since a thief may still be reading them.
+template <typename T>
+class chase_lev_deque {
+  static_assert(std::is_trivially_copyable_v<T>, "T is stored in atomics");
+
+ public:
+  // capacity: initial size of the ring, a power of two
+  explicit chase_lev_deque(std::int64_t capacity = 256) {
+    rings_.push_back(std::make_unique<ring>(capacity));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  chase_lev_deque(const chase_lev_deque&) = delete;
+  chase_lev_deque& operator=(const chase_lev_deque&) = delete;
+
+  // Owner only
+  void push(T value) {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    const std::int64_t t = top_.load(std::memory_order_acquire);
+    ring* r = ring_.load(std::memory_order_relaxed);
+    if (b - t > r->capacity - 1) {
+      rings_.push_back(r->grow(b, t));
+      r = rings_.back().get();
+      ring_.store(r, std::memory_order_release);
+    }
+    r->put(b, value);
+    // the paper's release fence and relaxed store, as one release store
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  // Owner only. False if the deque was empty or a thief took the last
+  // element first.
+  bool pop(T& value) {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    ring* r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = r->get(b);
+    if (t == b) {
+      // last element: race the thieves for it
+      const bool won = top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // Any thread. False if the deque was empty or another thread took the
+  // element first.
+  bool steal(T& value) {
+    std::int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    const ring* r = ring_.load(std::memory_order_acquire);
+    value = r->get(t);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed);
+  }
+
+  // A snapshot; may be stale by the time it returns.
+  bool empty() const {
+    return bottom_.load(std::memory_order_relaxed) <=
+           top_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Power-of-two ring indexed by the unwrapped top/bottom positions
+  struct ring {
+    explicit ring(std::int64_t cap)
+        : capacity(cap), slots(new std::atomic<T>[cap]) {}
+
+    T get(std::int64_t i) const {
+      return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+    void put(std::int64_t i, T value) {
+      slots[i & (capacity - 1)].store(value, std::memory_order_relaxed);
+    }
+    std::unique_ptr<ring> grow(std::int64_t b, std::int64_t t) const {
+      auto bigger = std::make_unique<ring>(2 * capacity);
+      for (std::int64_t i = t; i < b; ++i) bigger->put(i, get(i));
+      return bigger;
+    }
+
+    const std::int64_t capacity;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  alignas(64) std::atomic<std::int64_t> top_{0};
+  alignas(64) std::atomic<std::int64_t> bottom_{0};
+  alignas(64) std::atomic<ring*> ring_;
+  std::vector<std::unique_ptr<ring>> rings_;  // owner only
+};
+
+}  // namespace ws
+}  // namespace pad
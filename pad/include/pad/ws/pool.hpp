@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pad/kernels/policy.hpp"
+
+namespace pad {
+namespace ws {
+
+// Unit of work of a pool. `pending` is decremented once run() returned.
+struct task {
+  virtual ~task() = default;
+  virtual void run() = 0;
+  std::atomic<int>* pending = nullptr;
+};
+
+// Where an idle worker looks for work. random picks a victim uniformly;
+// numa_local_first pins the workers to PUs and tries every worker of its
+// own NUMA node (in random order) before one random worker elsewhere.
+enum class steal_order { random, numa_local_first };
+
+// "random", "numa_local_first"
+const char* name(steal_order order);
+
+// Totals over all workers since construction or the last reset.
+struct statistics {
+  long tasks;          // tasks run
+  long steals;         // tasks taken from another worker's deque
+  long failed_steals;  // attempts that found nothing or lost a race
+};
+
+// Fork-join thread pool with one Chase-Lev deque per worker. The thread that
+// calls run() takes part as worker 0; the others sleep between runs and spin
+// looking for work during one. Tasks must not throw. One run at a time: a
+// second caller waits for the first.
+class pool {
+ public:
+  // threads = 0: std::thread::hardware_concurrency()
+  explicit pool(int threads = 0, steal_order order = steal_order::random);
+  ~pool();
+
+  pool(const pool&) = delete;
+  pool& operator=(const pool&) = delete;
+
+  int size() const { return static_cast<int>(workers_.size()); }
+  steal_order order() const { return order_; }
+
+  // Runs f() on the calling thread as worker 0, with the other workers
+  // stealing the tasks it spawns. Called from inside a run of this pool,
+  // just calls f().
+  template <typename F>
+  void run(F&& f) {
+    if (inside()) {
+      f();
+      return;
+    }
+    enter();
+    f();
+    leave();
+  }
+
+  // Inside a run only: makes t available to the other workers. Call wait on
+  // its pending counter before t goes out of scope.
+  void spawn(task& t);
+
+  // Inside a run only: runs or steals tasks until pending drops to 0.
+  void wait(const std::atomic<int>& pending);
+
+  statistics stats() const;
+  void reset_stats();
+
+ private:
+  struct worker;
+
+  bool inside() const;
+  void enter();
+  void leave();
+  void loop(int index);
+  bool find(worker& w, task*& t);
+  void execute(worker& w, task* t);
+
+  const steal_order order_;
+  std::vector<std::unique_ptr<worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex run_mutex_;  // one run at a time
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  long epoch_ = 0;  // guarded by sleep_mutex_
+  bool stop_ = false;
+  std::atomic<bool> active_{false};
+  // Pool and worker index the running thread had before enter(), a worker
+  // of another pool for nested runs; guarded by run_mutex_
+  pool* outer_pool_ = nullptr;
+  int outer_index_ = -1;
+};
+
+namespace detail {
+template <typename Body>
+void for_range(pool& p, index_type begin, index_type end, index_type grain,
+               const Body& body);
+
+template <typename Body>
+struct for_task : task {
+  for_task(pool& p, index_type b, index_type e, index_type g, const Body& f)
+      : owner(p), begin(b), end(e), grain(g), body(f) {}
+  void run() override { for_range(owner, begin, end, grain, body); }
+  pool& owner;
+  index_type begin, end, grain;
+  const Body& body;
+};
+
+// Splits [begin, end) in halves down to `grain`, spawning the right half
+// and recursing into the left one.
+template <typename Body>
+void for_range(pool& p, index_type begin, index_type end, index_type grain,
+               const Body& body) {
+  if (end - begin <= grain) {
+    body(begin, end);
+    return;
+  }
+  const index_type mid = begin + (end - begin) / 2;
+  std::atomic<int> pending{1};
+  for_task<Body> right(p, mid, end, grain, body);
+  right.pending = &pending;
+  p.spawn(right);
+  for_range(p, begin, mid, grain, body);
+  p.wait(pending);
+}
+
+template <typename T, typename Body, typename Join>
+T reduce_range(pool& p, index_type begin, index_type end, index_type grain,
+               const T& identity, const Body& body, const Join& join);
+
+template <typename T, typename Body, typename Join>
+struct reduce_task : task {
+  reduce_task(pool& p, index_type b, index_type e, index_type g,
+              const T& id, const Body& f, const Join& j)
+      : owner(p), begin(b), end(e), grain(g), identity(id), body(f), join(j) {}
+  void run() override {
+    result = reduce_range(owner, begin, end, grain, identity, body, join);
+  }
+  pool& owner;
+  index_type begin, end, grain;
+  const T& identity;
+  const Body& body;
+  const Join& join;
+  T result;
+};
+
+template <typename T, typename Body, typename Join>
+T reduce_range(pool& p, index_type begin, index_type end, index_type grain,
+               const T& identity, const Body& body, const Join& join) {
+  if (end - begin <= grain) return body(begin, end, identity);
+  const index_type mid = begin + (end - begin) / 2;
+  std::atomic<int> pending{1};
+  reduce_task<T, Body, Join> right(p, mid, end, grain, identity, body, join);
+  right.pending = &pending;
+  p.spawn(right);
+  T left = reduce_range(p, begin, mid, grain, identity, body, join);
+  p.wait(pending);
+  return join(left, right.result);
+}
+}  // namespace detail
+
+// body(b, e) for subranges [b, e) of [begin, end) of at most grain_size
+// elements, on the workers of p.
+template <typename Body>
+void parallel_for(pool& p, index_type begin, index_type end,
+                  int grain_size, const Body& body) {
+  if (end <= begin) return;
+  const index_type grain = grain_size > 0 ? grain_size : 1;
+  p.run([&] { detail::for_range(p, begin, end, grain, body); });
+}
+
+// join of body(b, e, identity) over subranges [b, e) of [begin, end) of at
+// most grain_size elements. The subranges and the join tree depend only on
+// the range and grain_size, not on the threads or the steals.
+template <typename T, typename Body, typename Join>
+T parallel_reduce(pool& p, index_type begin, index_type end, int grain_size,
+                  const T& identity, const Body& body, const Join& join) {
+  if (end <= begin) return identity;
+  const index_type grain = grain_size > 0 ? grain_size : 1;
+  T result = identity;
+  p.run([&] {
+    result = detail::reduce_range(p, begin, end, grain, identity, body, join);
+  });
+  return result;
+}
+
+}  // namespace ws
+}  // namespace pad
@@ -0,0 +1,218 @@
+#include "pad/dispatch.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "pad/allocator.hpp"
+#include "pad/first_touch.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/topology.hpp"
+
+namespace pad {
+namespace dispatch {
+
+namespace {
+// Sizes the cost of every backend is fitted to: one far below the sizes
+// where the parallel paths start to pay off, `cached` with X and Y filling
+// half the last-level caches and `beyond` with X alone twice their size, so
+// that the line above the caches is fitted where the kernels stream DRAM.
+constexpr index_type small_n = index_type{1} << 10;
+
+struct sizes {
+  index_type cached;
+  index_type beyond;
+};
+
+sizes calibration_sizes() {
+  const index_type llc = topology::llc_total_bytes();
+  const index_type cached =
+      std::max<index_type>(llc / (4 * sizeof(float)), 4 * small_n);
+  return {cached, std::max<index_type>(2 * llc / sizeof(float), 4 * cached)};
+}
+
+// Calibration input that the allocator leaves untouched, so that the filling
+// policy places its pages
+using buffer = std::vector<float, ::numa::no_init_allocator<float>>;
+
+// Median of five rounds of the time per call, each round at least 0.2 ms.
+// Shorter than pad-tune's timing, since this runs inside the first call.
+template <typename F>
+double seconds_per_call(F&& f) {
+  using clock = std::chrono::steady_clock;
+  constexpr double min_round = 2e-4;
+  f();
+  long reps = 1;
+  for (;;) {
+    const auto start = clock::now();
+    for (long r = 0; r < reps; ++r) f();
+    const double t = std::chrono::duration<double>(clock::now() - start).count();
+    if (t >= min_round) break;
+    reps *= 2;
+  }
+  double rounds[5];
+  for (double& t : rounds) {
+    const auto start = clock::now();
+    for (long r = 0; r < reps; ++r) f();
+    t = std::chrono::duration<double>(clock::now() - start).count() / reps;
+  }
+  std::nth_element(rounds, rounds + 2, rounds + 5);
+  return rounds[2];
+}
+
+// Line through the times at small_n and n.cached, continued past it by the
+// line through the times at n.cached and n.beyond
+template <typename Run>
+cost fit(Run run, const sizes& n) {
+  const double t_small = seconds_per_call([&] { run(small_n); });
+  const double t_cached = seconds_per_call([&] { run(n.cached); });
+  const double t_beyond = seconds_per_call([&] { run(n.beyond); });
+  const double per_element =
+      std::max(0.0, (t_cached - t_small) / (n.cached - small_n));
+  const double per_element_beyond =
+      std::max(0.0, (t_beyond - t_cached) / (n.beyond - n.cached));
+  return {std::max(0.0, t_small - small_n * per_element), per_element,
+          n.cached, per_element_beyond};
+}
+
+// Powers of two up to the default team size, and that size itself.
+std::vector<int> team_sizes() {
+  const int max_threads = omp_get_max_threads();
+  std::vector<int> sizes;
+  for (int t = 2; t < max_threads; t *= 2) sizes.push_back(t);
+  sizes.push_back(max_threads);
+  return sizes;
+}
+
+calibration calibrate() {
+  const sizes n = calibration_sizes();
+  volatile float sink = 0;
+  auto reduce_with = [&](auto policy, const buffer& X) {
+    return fit([&](index_type m) {
+      sink = reduce(policy, X.begin(), X.begin() + m);
+    }, n);
+  };
+  // a = 0 keeps Y unchanged however often it runs
+  auto transform_with = [&](auto policy, const buffer& X, buffer& Y) {
+    return fit([&](index_type m) {
+      transform(policy, 0.0f, X.begin(), X.begin() + m, Y.begin());
+    }, n);
+  };
+
+  calibration c;
+  const auto at = [](backend b) { return static_cast<int>(b); };
+  {
+    // Pages placed by the calling thread, as most callers' vectors are
+    buffer X(n.beyond), Y(n.beyond);
+    std::fill(X.begin(), X.end(), 1.0f);
+    std::fill(Y.begin(), Y.end(), 2.0f);
+    c.omp_threads = team_sizes();
+    for (const int threads : c.omp_threads) {
+      c.omp_reduce.push_back(reduce_with(exec::omp_threads(threads), X));
+      c.omp_transform.push_back(
+          transform_with(exec::omp_threads(threads), X, Y));
+    }
+    c.reduce[at(backend::serial)] = reduce_with(exec::simd, X);
+    c.reduce[at(backend::omp)] = c.omp_reduce.back();
+    c.reduce[at(backend::tbb)] = reduce_with(exec::tbb, X);
+    c.transform[at(backend::serial)] = transform_with(exec::simd, X, Y);
+    c.transform[at(backend::omp)] = c.omp_transform.back();
+    c.transform[at(backend::tbb)] = transform_with(exec::tbb, X, Y);
+  }
+  // Pages on the node whose arena reads them, as exec::numa expects
+  buffer X(n.beyond), Y(n.beyond);
+  ::numa::first_touch(X, exec::numa, 1.0f);
+  ::numa::first_touch(Y, exec::numa, 2.0f);
+  c.reduce[at(backend::numa)] = reduce_with(exec::numa, X);
+  c.transform[at(backend::numa)] = transform_with(exec::numa, X, Y);
+  return c;
+}
+
+// Team size of the cheapest omp entry for n elements
+decision best_omp(const std::vector<int>& threads,
+                  const std::vector<cost>& costs,
+                  index_type n,
+                  double& t) {
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < costs.size(); ++i) {
+    if (costs[i](n) < costs[best](n)) best = i;
+  }
+  t = costs[best](n);
+  return {backend::omp, threads[best]};
+}
+
+bool forced(backend& b) {
+  static const int value = [] {
+    backend forced_backend;
+    const char* env = std::getenv("PAD_DISPATCH");
+    if (env != nullptr && from_name(env, forced_backend)) {
+      return static_cast<int>(forced_backend);
+    }
+    return -1;
+  }();
+  if (value < 0) return false;
+  b = static_cast<backend>(value);
+  return true;
+}
+}  // namespace
+
+const char* name(backend b) {
+  switch (b) {
+    case backend::serial:
+      return "serial";
+    case backend::omp:
+      return "omp";
+    case backend::tbb:
+      return "tbb";
+    default:
+      return "numa";
+  }
+}
+
+bool from_name(const char* name, backend& b) {
+  for (int i = 0; i < backend_count; ++i) {
+    if (std::strcmp(name, dispatch::name(static_cast<backend>(i))) == 0) {
+      b = static_cast<backend>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const calibration& calibrated() {
+  static const calibration c = calibrate();
+  return c;
+}
+
+decision choose(kernel k, index_type n) {
+  backend b;
+  if (forced(b)) return {b, 0};
+  const calibration& c = calibrated();
+  const bool is_reduce = k == kernel::reduce;
+  const cost* costs = is_reduce ? c.reduce : c.transform;
+
+  decision best = {backend::serial, 0};
+  double best_time = costs[static_cast<int>(backend::serial)](n);
+  double omp_time;
+  const decision omp = best_omp(
+      c.omp_threads, is_reduce ? c.omp_reduce : c.omp_transform, n, omp_time);
+  if (omp_time < best_time) {
+    best = omp;
+    best_time = omp_time;
+  }
+  for (const backend other : {backend::tbb, backend::numa}) {
+    const double t = costs[static_cast<int>(other)](n);
+    if (t < best_time) {
+      best = {other, 0};
+      best_time = t;
+    }
+  }
+  return best;
+}
+
+}  // namespace dispatch
+}  // namespace pad
@@ -0,0 +1,97 @@
+#include "pad/isa.hpp"
+
+#include <cpuid.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace pad {
+namespace isa {
+
+namespace sse42 {
+extern const kernel_table table;
+}
+namespace avx2 {
+extern const kernel_table table;
+}
+namespace avx512f {
+extern const kernel_table table;
+}
+
+namespace {
+// XCR0: which register states the OS saves on context switches.
+unsigned long long xgetbv0() {
+  unsigned eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+
+const kernel_table& table_for(level isa) {
+  switch (isa) {
+    case level::avx512f:
+      return avx512f::table;
+    case level::avx2:
+      return avx2::table;
+    default:
+      return sse42::table;
+  }
+}
+
+level requested(level detected) {
+  const char* env = std::getenv("PAD_ISA");
+  level isa;
+  if (env != nullptr && from_name(env, isa) && isa < detected) return isa;
+  return detected;
+}
+}  // namespace
+
+const char* name(level isa) {
+  switch (isa) {
+    case level::avx512f:
+      return "avx512f";
+    case level::avx2:
+      return "avx2";
+    default:
+      return "sse42";
+  }
+}
+
+bool from_name(const char* name, level& isa) {
+  for (auto candidate : {level::sse42, level::avx2, level::avx512f}) {
+    if (std::strcmp(name, isa::name(candidate)) == 0) {
+      isa = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+level detect() {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return level::sse42;
+  const bool fma = ecx & bit_FMA;
+  const bool avx = (ecx & bit_AVX) && (ecx & bit_OSXSAVE);
+  if (!avx) return level::sse42;
+
+  const unsigned long long xcr0 = xgetbv0();
+  const bool ymm_state = (xcr0 & 0x06) == 0x06;  // SSE, AVX
+  const bool zmm_state = (xcr0 & 0xe6) == 0xe6;  // + opmask, ZMM hi256/hi16
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return level::sse42;
+  const bool avx2 = ebx & bit_AVX2;
+  const bool avx512f = ebx & bit_AVX512F;
+
+  if (avx512f && avx2 && fma && zmm_state) return level::avx512f;
+  if (avx2 && fma && ymm_state) return level::avx2;
+  return level::sse42;
+}
+
+const kernel_table& kernels() {
+  static const kernel_table& selected = table_for(requested(detect()));
+  return selected;
+}
+
+const kernel_table& kernels(level isa) {
+  return table_for(isa);
+}
+
+}  // namespace isa
+}  // namespace pad
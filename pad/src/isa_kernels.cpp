@@ -0,0 +1,78 @@
+// Compiled once per ISA level, with PAD_ISA_BUILD, PAD_ISA_NAMESPACE (one of
+// the pad::isa::level names) and the matching -m flags set by
+// pad/CMakeLists.txt.
+#include "pad/isa.hpp"
+#include "pad/kernels/reduce.hpp"
+#include "pad/kernels/stream.hpp"
+#include "pad/kernels/transform.hpp"
+#include "pad/kernels/variants.hpp"
+
+#if !defined(PAD_ISA_BUILD) || !defined(PAD_ISA_NAMESPACE)
+#error "isa_kernels.cpp must be built through pad/CMakeLists.txt"
+#endif
+
+namespace pad {
+namespace isa {
+namespace PAD_ISA_NAMESPACE {
+namespace {
+void reduce_f32(const float* x,
+                index_type n,
+                std::array<float, simd_width>& acc) {
+  detail::reduce_vertical(x, n, acc);
+}
+
+void transform_f32(float a, const float* x, float* y, index_type n) {
+  detail::transform_simd(a, x, y, n);
+}
+
+void reduce_aligned_f32(const float* x,
+                        index_type n,
+                        std::array<float, simd_width>& acc) {
+  detail::reduce_vertical_aligned(x, n, acc);
+}
+
+void transform_aligned_f32(float a, const float* x, float* y, index_type n) {
+  detail::transform_simd_aligned(a, x, y, n);
+}
+
+void transform_to_f32(float a,
+                      const float* x,
+                      const float* y,
+                      float* z,
+                      index_type n) {
+  detail::transform_to_simd(a, x, y, z, n);
+}
+
+void transform_stream_f32(float a,
+                          const float* x,
+                          const float* y,
+                          float* z,
+                          index_type n) {
+  detail::transform_stream(a, x, y, z, n);
+}
+
+void reduce_prefetch_f32(const float* x,
+                         index_type n,
+                         std::array<float, simd_width>& acc,
+                         index_type distance) {
+  detail::reduce_vertical_prefetch(x, n, acc, distance);
+}
+
+void transform_prefetch_f32(float a,
+                            const float* x,
+                            float* y,
+                            index_type n,
+                            index_type distance) {
+  detail::transform_simd_prefetch(a, x, y, n, distance);
+}
+}  // namespace
+
+extern const kernel_table table{level::PAD_ISA_NAMESPACE, reduce_f32,
+                                transform_f32, reduce_aligned_f32,
+                                transform_aligned_f32, transform_to_f32,
+                                transform_stream_f32, reduce_prefetch_f32,
+                                transform_prefetch_f32,
+                                detail::variants<float>.data()};
+}  // namespace PAD_ISA_NAMESPACE
+}  // namespace isa
+}  // namespace pad
@@ -0,0 +1,38 @@
+#include "pad/numa.hpp"
+
+#include <memory>
+
+#include <oneapi/tbb/info.h>
+
+namespace pad {
+namespace numa {
+
+namespace {
+std::vector<std::unique_ptr<oneapi::tbb::task_arena>> make_arenas() {
+  using namespace oneapi::tbb;
+  std::vector<std::unique_ptr<task_arena>> arenas;
+  // A single entry of task_arena::automatic when tbbbind is not loaded
+  for (const numa_node_id id : info::numa_nodes()) {
+    arenas.push_back(std::make_unique<task_arena>(
+        task_arena::constraints{}.set_numa_id(id)));
+    arenas.back()->initialize();
+  }
+  return arenas;
+}
+
+const std::vector<std::unique_ptr<oneapi::tbb::task_arena>>& arenas() {
+  static const auto a = make_arenas();
+  return a;
+}
+}  // namespace
+
+int node_count() {
+  return static_cast<int>(arenas().size());
+}
+
+oneapi::tbb::task_arena& arena(int node) {
+  return *arenas()[node];
+}
+
+}  // namespace numa
+}  // namespace pad
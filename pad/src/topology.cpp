@@ -0,0 +1,146 @@
+#include "pad/topology.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+
+#include <hwloc.h>
+
+namespace pad {
+namespace topology {
+
+namespace {
+struct llc_info {
+  std::size_t bytes = std::size_t{8} << 20;
+  std::size_t total_bytes = std::size_t{8} << 20;
+};
+
+// The last-level cache is the outermost cache level hwloc finds.
+llc_info query_llc() {
+  llc_info info;
+  hwloc_topology_t topo;
+  if (hwloc_topology_init(&topo) != 0) return info;
+  if (hwloc_topology_load(topo) == 0) {
+    for (hwloc_obj_type_t type :
+         {HWLOC_OBJ_L5CACHE, HWLOC_OBJ_L4CACHE, HWLOC_OBJ_L3CACHE,
+          HWLOC_OBJ_L2CACHE, HWLOC_OBJ_L1CACHE}) {
+      const int count = hwloc_get_nbobjs_by_type(topo, type);
+      if (count <= 0) continue;
+      std::size_t largest = 0;
+      std::size_t total = 0;
+      for (int i = 0; i < count; ++i) {
+        const hwloc_obj_t obj = hwloc_get_obj_by_type(topo, type, i);
+        const std::size_t size = obj->attr->cache.size;
+        largest = size > largest ? size : largest;
+        total += size;
+      }
+      if (largest > 0) {
+        info.bytes = largest;
+        info.total_bytes = total;
+      }
+      break;
+    }
+  }
+  hwloc_topology_destroy(topo);
+  return info;
+}
+
+const llc_info& llc() {
+  static const llc_info info = query_llc();
+  return info;
+}
+
+// Share of one core in the first cache of each of the levels 1 to 3
+struct per_core_info {
+  std::size_t bytes[3] = {std::size_t{32} << 10, std::size_t{256} << 10,
+                          std::size_t{2} << 20};
+};
+
+per_core_info query_per_core() {
+  per_core_info info;
+  hwloc_topology_t topo;
+  if (hwloc_topology_init(&topo) != 0) return info;
+  if (hwloc_topology_load(topo) == 0) {
+    const hwloc_obj_type_t types[] = {HWLOC_OBJ_L1CACHE, HWLOC_OBJ_L2CACHE,
+                                      HWLOC_OBJ_L3CACHE};
+    for (int level = 0; level < 3; ++level) {
+      const hwloc_obj_t obj = hwloc_get_obj_by_type(topo, types[level], 0);
+      if (obj == nullptr || obj->attr->cache.size == 0) continue;
+      const int cores = hwloc_get_nbobjs_inside_cpuset_by_type(
+          topo, obj->cpuset, HWLOC_OBJ_CORE);
+      info.bytes[level] = obj->attr->cache.size / (cores > 0 ? cores : 1);
+    }
+  }
+  hwloc_topology_destroy(topo);
+  return info;
+}
+
+const per_core_info& per_core() {
+  static const per_core_info info = query_per_core();
+  return info;
+}
+
+// FNV-1a over a description of the topology.
+std::string query_fingerprint() {
+  std::string desc;
+  hwloc_topology_t topo;
+  if (hwloc_topology_init(&topo) == 0) {
+    if (hwloc_topology_load(topo) == 0) {
+      const hwloc_obj_t root = hwloc_get_root_obj(topo);
+      if (const char* model = hwloc_obj_get_info_by_name(root, "CPUModel")) {
+        desc += model;
+      } else if (const hwloc_obj_t package =
+                     hwloc_get_obj_by_type(topo, HWLOC_OBJ_PACKAGE, 0)) {
+        if (const char* m = hwloc_obj_get_info_by_name(package, "CPUModel")) {
+          desc += m;
+        }
+      }
+      for (hwloc_obj_type_t type :
+           {HWLOC_OBJ_PACKAGE, HWLOC_OBJ_NUMANODE, HWLOC_OBJ_CORE,
+            HWLOC_OBJ_PU, HWLOC_OBJ_L1CACHE, HWLOC_OBJ_L2CACHE,
+            HWLOC_OBJ_L3CACHE, HWLOC_OBJ_L4CACHE}) {
+        const int count = hwloc_get_nbobjs_by_type(topo, type);
+        desc += '/' + std::to_string(count);
+        if (hwloc_obj_type_is_cache(type) && count > 0) {
+          const hwloc_obj_t obj = hwloc_get_obj_by_type(topo, type, 0);
+          desc += 'x' + std::to_string(obj->attr->cache.size);
+        }
+      }
+    }
+    hwloc_topology_destroy(topo);
+  }
+
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (unsigned char c : desc) {
+    hash ^= c;
+    hash *= 0x100000001b3ull;
+  }
+  char hex[17];
+  std::snprintf(hex, sizeof hex, "%016llx",
+                static_cast<unsigned long long>(hash));
+  return hex;
+}
+}  // namespace
+
+std::size_t llc_bytes() {
+  return llc().bytes;
+}
+
+std::size_t llc_total_bytes() {
+  return llc().total_bytes;
+}
+
+std::size_t cache_bytes_per_core(int level) {
+  if (level < 1) level = 1;
+  if (level > 3) level = 3;
+  return per_core().bytes[level - 1];
+}
+
+const std::string& fingerprint() {
+  static const std::string id = query_fingerprint();
+  return id;
+}
+
+}  // namespace topology
+}  // namespace pad
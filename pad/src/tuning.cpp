@@ -0,0 +1,279 @@
+#include "pad/tuning.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "pad/kernels/variants.hpp"
+#include "pad/topology.hpp"
+
+namespace pad {
+namespace tuning {
+
+namespace {
+// A table entry resolved to the kernel it names.
+struct resolved {
+  index_type max_elements;
+  const isa::kernel_variant<float>* kernel;
+};
+
+struct state {
+  std::string source;
+  std::vector<resolved> reduce;
+  std::vector<resolved> transform;
+};
+
+const isa::kernel_variant<float>* find(const choice& c) {
+  if (c.isa > isa::detect()) return nullptr;
+  const isa::kernel_variant<float>* grid = isa::kernels(c.isa).variants_f32;
+  for (std::size_t i = 0; i < variant_count; ++i) {
+    if (grid[i].width == c.width && grid[i].unroll == c.unroll &&
+        grid[i].aligned == c.aligned) {
+      return &grid[i];
+    }
+  }
+  return nullptr;
+}
+
+std::vector<resolved> resolve(const std::vector<choice>& choices) {
+  std::vector<resolved> out;
+  for (const auto& c : choices) {
+    if (const auto* kernel = find(c)) out.push_back({c.max_elements, kernel});
+  }
+  std::sort(out.begin(), out.end(), [](const resolved& a, const resolved& b) {
+    return a.max_elements < b.max_elements;
+  });
+  return out;
+}
+
+state load() {
+  state s;
+  table t;
+  const std::string path = default_path();
+  if (!path.empty() && read(path, t)) {
+    s.source = path;
+    s.reduce = resolve(t.reduce);
+    s.transform = resolve(t.transform);
+  }
+  return s;
+}
+
+const state& loaded() {
+  static const state s = load();
+  return s;
+}
+
+// Entries are sorted by max_elements; the last one covers larger sizes.
+const isa::kernel_variant<float>* lookup(const std::vector<resolved>& entries,
+                                    index_type n) {
+  if (entries.empty()) return nullptr;
+  for (const auto& e : entries) {
+    if (n <= e.max_elements) return e.kernel;
+  }
+  return entries.back().kernel;
+}
+
+// $XDG_CACHE_HOME/pad or $HOME/.cache/pad
+std::string cache_dir() {
+  if (const char* cache = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(cache) + "/pad";
+  }
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/pad";
+  }
+  return {};
+}
+
+struct tbb_state {
+  std::string source;
+  std::vector<tbb_choice> choices;
+};
+
+tbb_state load_tbb() {
+  tbb_state s;
+  const std::string path = tbb_cache_path();
+  if (!path.empty() && read(path, s.choices)) s.source = path;
+  std::sort(s.choices.begin(), s.choices.end(),
+            [](const tbb_choice& a, const tbb_choice& b) {
+              return a.max_elements < b.max_elements;
+            });
+  return s;
+}
+
+const tbb_state& loaded_tbb() {
+  static const tbb_state s = load_tbb();
+  return s;
+}
+
+template <typename Enum, std::size_t N>
+bool parse(const std::string& text, const Enum (&values)[N], Enum& out) {
+  for (Enum v : values) {
+    if (text == name(v)) {
+      out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+const partitioner all_partitioners[] = {
+    partitioner::automatic, partitioner::simple, partitioner::static_,
+    partitioner::affinity};
+const tbb_kernel all_kernels[] = {tbb_kernel::reduce, tbb_kernel::transform};
+
+void write_choices(std::ostream& os,
+                   const char* op,
+                   const std::vector<choice>& choices) {
+  for (const auto& c : choices) {
+    os << op << ' ' << c.max_elements << ' ' << isa::name(c.isa) << ' '
+       << c.width << ' ' << c.unroll << ' ' << (c.aligned ? 1 : 0) << '\n';
+  }
+}
+}  // namespace
+
+std::string default_path() {
+  if (const char* file = std::getenv("PAD_TUNING_FILE")) return file;
+  const std::string dir = cache_dir();
+  return dir.empty() ? dir : dir + "/tuning.txt";
+}
+
+bool write(const std::string& path, const table& t) {
+  std::ofstream os(path);
+  if (!os) return false;
+  os << "# pad tuning: op max_elements isa width unroll aligned\n";
+  write_choices(os, "reduce", t.reduce);
+  write_choices(os, "transform", t.transform);
+  return static_cast<bool>(os);
+}
+
+bool read(const std::string& path, table& t) {
+  std::ifstream is(path);
+  if (!is) return false;
+  table result;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string op, isa_name;
+    choice c;
+    int aligned;
+    if (!(fields >> op >> c.max_elements >> isa_name >> c.width >> c.unroll >>
+          aligned) ||
+        !isa::from_name(isa_name.c_str(), c.isa)) {
+      return false;
+    }
+    c.aligned = aligned != 0;
+    if (op == "reduce") {
+      result.reduce.push_back(c);
+    } else if (op == "transform") {
+      result.transform.push_back(c);
+    } else {
+      return false;
+    }
+  }
+  t = std::move(result);
+  return true;
+}
+
+const std::string& loaded_from() {
+  return loaded().source;
+}
+
+const char* name(partitioner p) {
+  switch (p) {
+    case partitioner::simple:
+      return "simple";
+    case partitioner::static_:
+      return "static";
+    case partitioner::affinity:
+      return "affinity";
+    default:
+      return "auto";
+  }
+}
+
+const char* name(tbb_kernel k) {
+  return k == tbb_kernel::reduce ? "reduce" : "transform";
+}
+
+std::string tbb_cache_path() {
+  if (const char* file = std::getenv("PAD_TBB_TUNING_FILE")) return file;
+  const std::string path = default_path();
+  const auto slash = path.rfind('/');
+  const std::string dir =
+      slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+  return dir + "/tbb-" + topology::fingerprint() + ".txt";
+}
+
+bool write(const std::string& path, const std::vector<tbb_choice>& choices) {
+  std::ofstream os(path);
+  if (!os) return false;
+  os << "# pad tbb tuning for topology " << topology::fingerprint()
+     << ": kernel max_elements threads partitioner grain_size\n";
+  for (const auto& c : choices) {
+    os << name(c.kernel) << ' ' << c.max_elements << ' ' << c.threads << ' '
+       << name(c.part) << ' ' << c.grain_size << '\n';
+  }
+  return static_cast<bool>(os);
+}
+
+bool read(const std::string& path, std::vector<tbb_choice>& choices) {
+  std::ifstream is(path);
+  if (!is) return false;
+  std::vector<tbb_choice> result;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string kernel, part;
+    tbb_choice c;
+    if (!(fields >> kernel >> c.max_elements >> c.threads >> part >>
+          c.grain_size) ||
+        !parse(kernel, all_kernels, c.kernel) ||
+        !parse(part, all_partitioners, c.part) || c.grain_size < 1) {
+      return false;
+    }
+    result.push_back(c);
+  }
+  choices = std::move(result);
+  return true;
+}
+
+const std::string& tbb_loaded_from() {
+  return loaded_tbb().source;
+}
+
+const tbb_choice* tbb_lookup(tbb_kernel kernel, index_type n, int threads) {
+  const auto& choices = loaded_tbb().choices;
+  // Nearest tuned thread count for this kernel
+  int nearest = -1;
+  for (const auto& c : choices) {
+    if (c.kernel != kernel) continue;
+    if (nearest < 0 ||
+        std::abs(c.threads - threads) < std::abs(nearest - threads)) {
+      nearest = c.threads;
+    }
+  }
+  if (nearest < 0) return nullptr;
+  // choices are sorted by max_elements
+  const tbb_choice* last = nullptr;
+  for (const auto& c : choices) {
+    if (c.kernel != kernel || c.threads != nearest) continue;
+    if (n <= c.max_elements) return &c;
+    last = &c;
+  }
+  return last;
+}
+
+const isa::kernel_variant<float>* reduce_f32(index_type n) {
+  return lookup(loaded().reduce, n);
+}
+
+const isa::kernel_variant<float>* transform_f32(index_type n) {
+  return lookup(loaded().transform, n);
+}
+
+}  // namespace tuning
+}  // namespace pad
+
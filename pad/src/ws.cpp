@@ -0,0 +1,235 @@
+#include "pad/ws/pool.hpp"
+
+#include <hwloc.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "pad/ws/deque.hpp"
+
+namespace pad {
+namespace ws {
+
+struct alignas(64) pool::worker {
+  chase_lev_deque<task*> deque;
+  std::uint64_t rng;
+  std::vector<int> near;  // other workers on the same NUMA node
+  std::vector<int> far;   // all other workers
+  std::atomic<long> tasks{0};
+  std::atomic<long> steals{0};
+  std::atomic<long> failed_steals{0};
+
+  // xorshift64
+  std::uint64_t next() {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+  }
+};
+
+namespace {
+thread_local pool* current_pool = nullptr;
+thread_local int current_index = -1;
+
+void pause() {
+#if defined(__SSE2__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// NUMA node of every worker, worker i running on PU i % PUs (see
+// pin_to_pu).
+std::vector<int> worker_nodes(int workers, hwloc_topology_t topo) {
+  std::vector<int> nodes(workers, 0);
+  const int pus = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_PU);
+  const int numa = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_NUMANODE);
+  if (pus <= 0) return nodes;
+  for (int i = 0; i < workers; ++i) {
+    const hwloc_obj_t pu = hwloc_get_obj_by_type(topo, HWLOC_OBJ_PU, i % pus);
+    for (int n = 0; n < numa; ++n) {
+      const hwloc_obj_t node =
+          hwloc_get_obj_by_type(topo, HWLOC_OBJ_NUMANODE, n);
+      if (hwloc_bitmap_isset(node->cpuset, pu->os_index)) nodes[i] = n;
+    }
+  }
+  return nodes;
+}
+
+// Binds the calling thread to PU index % PUs. The thread that calls run()
+// is never bound and counts as being on PU 0.
+void pin_to_pu(int index) {
+  hwloc_topology_t topo;
+  if (hwloc_topology_init(&topo) != 0) return;
+  if (hwloc_topology_load(topo) == 0) {
+    const int pus = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_PU);
+    if (pus > 0) {
+      const hwloc_obj_t pu =
+          hwloc_get_obj_by_type(topo, HWLOC_OBJ_PU, index % pus);
+      hwloc_set_cpubind(topo, pu->cpuset, HWLOC_CPUBIND_THREAD);
+    }
+  }
+  hwloc_topology_destroy(topo);
+}
+}  // namespace
+
+const char* name(steal_order order) {
+  return order == steal_order::random ? "random" : "numa_local_first";
+}
+
+pool::pool(int threads, steal_order order) : order_(order) {
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<int> nodes(threads, 0);
+  if (order_ == steal_order::numa_local_first) {
+    hwloc_topology_t topo;
+    if (hwloc_topology_init(&topo) == 0) {
+      if (hwloc_topology_load(topo) == 0) nodes = worker_nodes(threads, topo);
+      hwloc_topology_destroy(topo);
+    }
+  }
+  for (int i = 0; i < threads; ++i) {
+    workers_.push_back(std::make_unique<worker>());
+    worker& w = *workers_.back();
+    w.rng = 0x9e3779b97f4a7c15ull * (i + 1);
+    for (int j = 0; j < threads; ++j) {
+      if (j == i) continue;
+      w.far.push_back(j);
+      if (nodes[j] == nodes[i]) w.near.push_back(j);
+    }
+  }
+  // worker 0 is whoever calls run()
+  for (int i = 1; i < threads; ++i) {
+    threads_.emplace_back([this, i] { loop(i); });
+  }
+}
+
+pool::~pool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+bool pool::inside() const {
+  return current_pool == this;
+}
+
+void pool::enter() {
+  run_mutex_.lock();
+  outer_pool_ = current_pool;
+  outer_index_ = current_index;
+  current_pool = this;
+  current_index = 0;
+  active_.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    ++epoch_;
+  }
+  wake_.notify_all();
+}
+
+void pool::leave() {
+  active_.store(false, std::memory_order_release);
+  current_pool = outer_pool_;
+  current_index = outer_index_;
+  run_mutex_.unlock();
+}
+
+void pool::loop(int index) {
+  if (order_ == steal_order::numa_local_first) pin_to_pu(index);
+  current_pool = this;
+  current_index = index;
+  worker& w = *workers_[index];
+  long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [&] { return stop_ || epoch_ != seen; });
+      if (stop_) return;
+      seen = epoch_;
+    }
+    while (active_.load(std::memory_order_acquire)) {
+      task* t;
+      if (find(w, t)) {
+        execute(w, t);
+      } else {
+        pause();
+      }
+    }
+  }
+}
+
+// Own deque first, then one round of stealing in the configured order.
+bool pool::find(worker& w, task*& t) {
+  if (w.deque.pop(t)) return true;
+  if (w.far.empty()) return false;
+  auto try_steal = [&](int victim) {
+    if (workers_[victim]->deque.steal(t)) {
+      w.steals.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    w.failed_steals.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  };
+  if (order_ == steal_order::numa_local_first && !w.near.empty()) {
+    const std::size_t start = w.next() % w.near.size();
+    for (std::size_t k = 0; k < w.near.size(); ++k) {
+      if (try_steal(w.near[(start + k) % w.near.size()])) return true;
+    }
+  }
+  return try_steal(w.far[w.next() % w.far.size()]);
+}
+
+void pool::execute(worker& w, task* t) {
+  std::atomic<int>* pending = t->pending;
+  t->run();
+  w.tasks.fetch_add(1, std::memory_order_relaxed);
+  pending->fetch_sub(1, std::memory_order_release);
+}
+
+void pool::spawn(task& t) {
+  workers_[current_index]->deque.push(&t);
+}
+
+void pool::wait(const std::atomic<int>& pending) {
+  worker& w = *workers_[current_index];
+  while (pending.load(std::memory_order_acquire) != 0) {
+    task* t;
+    if (find(w, t)) {
+      execute(w, t);
+    } else {
+      pause();
+    }
+  }
+}
+
+statistics pool::stats() const {
+  statistics s{0, 0, 0};
+  for (const auto& w : workers_) {
+    s.tasks += w->tasks.load(std::memory_order_relaxed);
+    s.steals += w->steals.load(std::memory_order_relaxed);
+    s.failed_steals += w->failed_steals.load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+void pool::reset_stats() {
+  for (auto& w : workers_) {
+    w->tasks.store(0, std::memory_order_relaxed);
+    w->steals.store(0, std::memory_order_relaxed);
+    w->failed_steals.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace ws
+}  // namespace pad
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace pad {
+namespace tools {
+
+// Best of a few rounds of the time per call, each round long enough to
+// drown out the clock resolution.
+template <typename F>
+double seconds_per_call(F&& f) {
+  using clock = std::chrono::steady_clock;
+  constexpr double min_round = 0.01;
+  long reps = 1;
+  for (;;) {
+    const auto start = clock::now();
+    for (long r = 0; r < reps; ++r) f();
+    const double t = std::chrono::duration<double>(clock::now() - start).count();
+    if (t >= min_round) break;
+    reps *= 2;
+  }
+  double best = 1e30;
+  for (int round = 0; round < 3; ++round) {
+    const auto start = clock::now();
+    for (long r = 0; r < reps; ++r) f();
+    best = std::min(
+        best, std::chrono::duration<double>(clock::now() - start).count() /
+                  reps);
+  }
+  return best;
+}
+
+}  // namespace tools
+}  // namespace pad
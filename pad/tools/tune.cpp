@@ -0,0 +1,84 @@
+// pad-tune: measures every kernel of the compile-time grid (width x unroll x
+// aligned, for each ISA level the host supports) on each size class, and
+// writes the fastest one per class to the tuning file that exec::tuned
+// reads at startup.
+//
+//   pad-tune [output file]     default: pad::tuning::default_path()
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "pad/isa.hpp"
+#include "pad/kernels/variants.hpp"
+#include "pad/tuning.hpp"
+#include "timing.hpp"
+
+namespace {
+using pad::index_type;
+using pad::isa::kernel_variant;
+using pad::tools::seconds_per_call;
+
+template <typename Measure>
+pad::tuning::choice fastest(const char* op, index_type n, Measure measure) {
+  pad::tuning::choice best{n, pad::isa::level::sse42, 0, 0, false};
+  double best_time = 1e30;
+  const auto detected = pad::isa::detect();
+  for (auto isa : {pad::isa::level::sse42, pad::isa::level::avx2,
+                   pad::isa::level::avx512f}) {
+    if (isa > detected) break;
+    const kernel_variant<float>* grid = pad::isa::kernels(isa).variants_f32;
+    for (std::size_t i = 0; i < pad::variant_count; ++i) {
+      const double t = measure(grid[i]);
+      if (t < best_time) {
+        best_time = t;
+        best = {n, isa, grid[i].width, grid[i].unroll, grid[i].aligned};
+      }
+    }
+  }
+  std::printf("%-9s %10td  %-7s width %2d unroll %d %-9s %8.3f GB/s\n", op, n,
+              pad::isa::name(best.isa), best.width, best.unroll,
+              best.aligned ? "aligned" : "unaligned",
+              (op[0] == 'r' ? 1 : 3) * n * sizeof(float) / best_time * 1e-9);
+  return best;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string path = argc > 1 ? argv[1] : pad::tuning::default_path();
+  if (path.empty()) {
+    std::fprintf(stderr, "pad-tune: no output file, pass one or set HOME\n");
+    return 1;
+  }
+
+  const index_type largest = std::end(pad::tuning::size_classes)[-1];
+  std::vector<float> X(largest), Y(largest, 2);
+  std::iota(X.begin(), X.end(), 1.f);
+  volatile float sink = 0;
+
+  pad::tuning::table t;
+  for (index_type n : pad::tuning::size_classes) {
+    t.reduce.push_back(
+        fastest("reduce", n, [&](const kernel_variant<float>& k) {
+          return seconds_per_call([&] { sink = k.reduce(X.data(), n); });
+        }));
+    t.transform.push_back(
+        fastest("transform", n, [&](const kernel_variant<float>& k) {
+          return seconds_per_call(
+              [&] { k.transform(-1.f, X.data(), Y.data(), n); });
+        }));
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), ec);
+  if (!pad::tuning::write(path, t)) {
+    std::fprintf(stderr, "pad-tune: cannot write %s\n", path.c_str());
+    return 1;
+  }
+  std::printf("wrote %s\n", path.c_str());
+  return 0;
+}
@@ -0,0 +1,121 @@
+// pad-tune-tbb: measures the TBB reduce and transform kernels with every
+// partitioner and a range of grain sizes, for each size class and for
+// thread counts 1, 2, 4, ... up to the machine's concurrency. The fastest
+// (partitioner, grain) per case goes to the cache file that the
+// partitioner-less pad::reduce/transform(exec::tbb, ...) read.
+//
+//   pad-tune-tbb [output file]   default: pad::tuning::tbb_cache_path()
+
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/task_arena.h>
+
+#include "pad/kernels.hpp"
+#include "pad/topology.hpp"
+#include "pad/tuning.hpp"
+#include "timing.hpp"
+
+namespace {
+using pad::index_type;
+using pad::tools::seconds_per_call;
+using pad::tuning::partitioner;
+using pad::tuning::tbb_kernel;
+
+constexpr int grain_sizes[] = {1, 4, 16, 64, 256, 1024};
+
+template <typename Run>
+double measure(partitioner p, Run run) {
+  using namespace oneapi::tbb;
+  switch (p) {
+    case partitioner::simple: {
+      simple_partitioner part;
+      return seconds_per_call([&] { run(part); });
+    }
+    case partitioner::static_: {
+      static_partitioner part;
+      return seconds_per_call([&] { run(part); });
+    }
+    case partitioner::affinity: {
+      affinity_partitioner part;
+      return seconds_per_call([&] { run(part); });
+    }
+    default: {
+      auto_partitioner part;
+      return seconds_per_call([&] { run(part); });
+    }
+  }
+}
+
+std::vector<int> thread_counts() {
+  const int max = oneapi::tbb::info::default_concurrency();
+  std::vector<int> counts;
+  for (int t = 1; t < max; t *= 2) counts.push_back(t);
+  counts.push_back(max);
+  return counts;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string path =
+      argc > 1 ? argv[1] : pad::tuning::tbb_cache_path();
+
+  const index_type largest = std::end(pad::tuning::tbb_size_classes)[-1];
+  std::vector<float> X(largest), Y(largest, 2);
+  std::iota(X.begin(), X.end(), 1.f);
+  volatile float sink = 0;
+
+  std::printf("topology %s\n", pad::topology::fingerprint().c_str());
+  std::vector<pad::tuning::tbb_choice> choices;
+  for (tbb_kernel kernel : {tbb_kernel::reduce, tbb_kernel::transform}) {
+    for (index_type n : pad::tuning::tbb_size_classes) {
+      for (int threads : thread_counts()) {
+        pad::tuning::tbb_choice best{kernel, n, threads,
+                                     partitioner::automatic, 1};
+        double best_time = 1e30;
+        oneapi::tbb::task_arena arena(threads);
+        arena.execute([&] {
+          for (partitioner p : {partitioner::automatic, partitioner::simple,
+                                partitioner::static_, partitioner::affinity}) {
+            for (int grain : grain_sizes) {
+              const double t = measure(p, [&](auto& part) {
+                if (kernel == tbb_kernel::reduce) {
+                  sink = pad::reduce(pad::exec::tbb, X.begin(),
+                                     X.begin() + n, part, grain);
+                } else {
+                  pad::transform(pad::exec::tbb, -1.f, X.begin(),
+                                 X.begin() + n, Y.begin(), part, grain);
+                }
+              });
+              if (t < best_time) {
+                best_time = t;
+                best.part = p;
+                best.grain_size = grain;
+              }
+            }
+          }
+        });
+        std::printf("%-9s %10td  %3d threads  %-8s grain %4d  %8.3f GB/s\n",
+                    pad::tuning::name(kernel), n, threads,
+                    pad::tuning::name(best.part), best.grain_size,
+                    (kernel == tbb_kernel::reduce ? 1 : 3) * n *
+                        sizeof(float) / best_time * 1e-9);
+        choices.push_back(best);
+      }
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), ec);
+  if (!pad::tuning::write(path, choices)) {
+    std::fprintf(stderr, "pad-tune-tbb: cannot write %s\n", path.c_str());
+    return 1;
+  }
+  std::printf("wrote %s\n", path.c_str());
+  return 0;
+}